@@ -0,0 +1,353 @@
+/* ****************************************************************************
+ * FILE:        analyze.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Reports on a request trace without simulating it (--analyze):
+ *              how many requests are out of range or go nowhere, the mix of
+ *              directions, the average trip and per-floor histograms.
+ *
+ *              The requests are copied into two flat arrays (start floors,
+ *              destination floors) and checked with vector instructions, 
+ *              8 requests at a time with AVX2 or 4 with SSE2, picked at run
+ *              time. Every comparison gives a lane of all ones or zeros, so
+ *              counting is just subtracting the comparison from a counter;
+ *              the floor histograms compare every lane against each floor.
+ *              Other CPUs, and the leftover requests, use the scalar code.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "analyze.h"
+#include "fileio.h"
+#include "linked_list.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/* ****************************************************************************
+ * NAME:        analyzeTrace
+ * 
+ * PURPOSE:     Read a trace and print its statistics. Lines that can't be 
+ *              read as requests at all are reported by readTrace(), every
+ *              other line reaches the kernel, however bad its floors.
+ * 
+ * IMPORT:      filename - the trace
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int analyzeTrace(char* filename)
+{
+    int status = 0;
+    const char* kernelName = NULL;
+    TraceStats stats;
+    LinkedList* requests = createLinkedList();
+
+    // Every floor is kept, range checks are done by the kernel
+    if (readTrace(filename, requests) == -1)
+    {
+        printf("failed to read %s\n", filename);
+        status = -1;
+    }
+    else
+    {
+        int count = requests->size;
+        void* startMem = NULL;
+        void* destMem = NULL;
+
+        if (posix_memalign(&startMem, 32, sizeof(int) * (count + 1)) != 0 ||
+            posix_memalign(&destMem, 32, sizeof(int) * (count + 1)) != 0)
+        {
+            perror("failed to allocate the trace");
+            exit(1);
+        }
+
+        int* start = (int*)startMem;
+        int* dest = (int*)destMem;
+        int ii = 0;
+        for (RequestNode* node = requests->head; node != NULL; 
+             node = node->next)
+        {
+            start[ii] = node->req->start;
+            dest[ii] = node->req->destination;
+            ii++;
+        }
+
+        memset(&stats, 0, sizeof(stats));
+        AnalyzeKernel kernel = chooseKernel(&kernelName);
+        kernel(start, dest, count, &stats);
+
+        long long valid = stats.requests - stats.invalid;
+        printf("requests: %lld (%lld with floors outside %d-%d, %lld from "
+               "and to the same floor)\n", stats.requests, stats.invalid,
+               GROUND_FLOOR, NUM_FLOORS, stats.sameFloor);
+        printf("direction: %lld up (%.1f%%), %lld down (%.1f%%)\n", 
+               stats.up, valid > 0 ? 100.0 * stats.up / valid : 0.0,
+               stats.down, valid > 0 ? 100.0 * stats.down / valid : 0.0);
+        printf("average trip: %.2f floors\n", 
+               valid > 0 ? (double)stats.tripFloors / valid : 0.0);
+        printf("floor,pickups,dropoffs\n");
+        for (int jj = GROUND_FLOOR; jj <= NUM_FLOORS; jj++)
+        {
+            printf("%d,%lld,%lld\n", jj, stats.pickups[jj], 
+                   stats.dropoffs[jj]);
+        }
+        printf("(checked with %s)\n", kernelName);
+
+        free(start);
+        free(dest);
+    }
+
+    freeLinkedList(requests);
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        chooseKernel
+ * 
+ * PURPOSE:     Pick the widest kernel this CPU can run.
+ * 
+ * IMPORT:      name - set to the kernel's name
+ * EXPORT:      the kernel
+ * ***************************************************************************/
+AnalyzeKernel chooseKernel(const char** name)
+{
+    AnalyzeKernel kernel = analyzeScalar;
+    *name = "scalar code";
+
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernel = analyzeAvx2;
+        *name = "AVX2";
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        kernel = analyzeSse2;
+        *name = "SSE2";
+    }
+#endif
+
+    return kernel;
+}
+
+/* ****************************************************************************
+ * NAME:        analyzeScalar
+ * 
+ * PURPOSE:     Kernel for any CPU (and the vector kernels' leftovers).
+ * 
+ * IMPORT:      start, dest - floors of each request
+ *              count - number of requests
+ *              stats - stats to add to
+ * ***************************************************************************/
+void analyzeScalar(const int* start, const int* dest, int count, 
+                   TraceStats* stats)
+{
+    for (int ii = 0; ii < count; ii++)
+    {
+        int from = start[ii], to = dest[ii];
+
+        stats->requests++;
+        if (from < GROUND_FLOOR || from > NUM_FLOORS || 
+            to < GROUND_FLOOR || to > NUM_FLOORS)
+        {
+            stats->invalid++;
+        }
+        else
+        {
+            stats->sameFloor += (from == to);
+            stats->up += (to > from);
+            stats->down += (to < from);
+            stats->tripFloors += abs(to - from);
+            stats->pickups[from]++;
+            stats->dropoffs[to]++;
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/* ****************************************************************************
+ * NAME:        analyzeSse2
+ * 
+ * PURPOSE:     Kernel checking 4 requests per instruction.
+ * 
+ * IMPORT:      start, dest - floors of each request
+ *              count - number of requests
+ *              stats - stats to add to
+ * ***************************************************************************/
+__attribute__((target("sse2")))
+void analyzeSse2(const int* start, const int* dest, int count, 
+                 TraceStats* stats)
+{
+    const __m128i below = _mm_set1_epi32(GROUND_FLOOR - 1);
+    const __m128i above = _mm_set1_epi32(NUM_FLOORS + 1);
+    int lanes[4];
+    int done = count - count % 4;
+
+    for (int base = 0; base < done; base += ANALYZE_BLOCK)
+    {
+        int end = (base + ANALYZE_BLOCK < done) ? base + ANALYZE_BLOCK : done;
+        __m128i invalid = _mm_setzero_si128(), same = _mm_setzero_si128();
+        __m128i up = _mm_setzero_si128(), down = _mm_setzero_si128();
+        __m128i trip = _mm_setzero_si128();
+        __m128i pickups[NUM_FLOORS + 1], dropoffs[NUM_FLOORS + 1];
+
+        for (int ff = GROUND_FLOOR; ff <= NUM_FLOORS; ff++)
+        {
+            pickups[ff] = _mm_setzero_si128();
+            dropoffs[ff] = _mm_setzero_si128();
+        }
+
+        for (int ii = base; ii < end; ii += 4)
+        {
+            __m128i from = _mm_loadu_si128((const __m128i*)&start[ii]);
+            __m128i to = _mm_loadu_si128((const __m128i*)&dest[ii]);
+
+            // valid = both floors strictly between below and above
+            __m128i valid = _mm_and_si128(
+                _mm_and_si128(_mm_cmpgt_epi32(from, below), 
+                              _mm_cmplt_epi32(from, above)),
+                _mm_and_si128(_mm_cmpgt_epi32(to, below), 
+                              _mm_cmplt_epi32(to, above)));
+            invalid = _mm_sub_epi32(invalid, 
+                                    _mm_andnot_si128(valid, _mm_set1_epi32(-1)));
+            same = _mm_sub_epi32(same, 
+                                 _mm_and_si128(valid, _mm_cmpeq_epi32(from, to)));
+            up = _mm_sub_epi32(up, 
+                               _mm_and_si128(valid, _mm_cmpgt_epi32(to, from)));
+            down = _mm_sub_epi32(down, 
+                                 _mm_and_si128(valid, _mm_cmplt_epi32(to, from)));
+
+            // |to - from| = (diff ^ sign) - sign
+            __m128i diff = _mm_sub_epi32(to, from);
+            __m128i sign = _mm_srai_epi32(diff, 31);
+            diff = _mm_sub_epi32(_mm_xor_si128(diff, sign), sign);
+            trip = _mm_add_epi32(trip, _mm_and_si128(valid, diff));
+
+            // Invalid lanes are outside every floor, so never match
+            for (int ff = GROUND_FLOOR; ff <= NUM_FLOORS; ff++)
+            {
+                __m128i floor = _mm_set1_epi32(ff);
+                pickups[ff] = _mm_sub_epi32(pickups[ff], 
+                    _mm_and_si128(valid, _mm_cmpeq_epi32(from, floor)));
+                dropoffs[ff] = _mm_sub_epi32(dropoffs[ff], 
+                    _mm_and_si128(valid, _mm_cmpeq_epi32(to, floor)));
+            }
+        }
+
+        // Add the lanes up into the totals
+        stats->requests += end - base;
+#define SUM_LANES(vec, total) \
+        _mm_storeu_si128((__m128i*)lanes, vec); \
+        total += (long long)lanes[0] + lanes[1] + lanes[2] + lanes[3]
+        SUM_LANES(invalid, stats->invalid);
+        SUM_LANES(same, stats->sameFloor);
+        SUM_LANES(up, stats->up);
+        SUM_LANES(down, stats->down);
+        SUM_LANES(trip, stats->tripFloors);
+        for (int ff = GROUND_FLOOR; ff <= NUM_FLOORS; ff++)
+        {
+            SUM_LANES(pickups[ff], stats->pickups[ff]);
+            SUM_LANES(dropoffs[ff], stats->dropoffs[ff]);
+        }
+#undef SUM_LANES
+    }
+
+    analyzeScalar(start + done, dest + done, count - done, stats);
+}
+
+/* ****************************************************************************
+ * NAME:        analyzeAvx2
+ * 
+ * PURPOSE:     Kernel checking 8 requests per instruction.
+ * 
+ * IMPORT:      start, dest - floors of each request
+ *              count - number of requests
+ *              stats - stats to add to
+ * ***************************************************************************/
+__attribute__((target("avx2")))
+void analyzeAvx2(const int* start, const int* dest, int count, 
+                 TraceStats* stats)
+{
+    const __m256i below = _mm256_set1_epi32(GROUND_FLOOR - 1);
+    const __m256i above = _mm256_set1_epi32(NUM_FLOORS + 1);
+    int lanes[8];
+    int done = count - count % 8;
+
+    for (int base = 0; base < done; base += ANALYZE_BLOCK)
+    {
+        int end = (base + ANALYZE_BLOCK < done) ? base + ANALYZE_BLOCK : done;
+        __m256i invalid = _mm256_setzero_si256();
+        __m256i same = _mm256_setzero_si256();
+        __m256i up = _mm256_setzero_si256(), down = _mm256_setzero_si256();
+        __m256i trip = _mm256_setzero_si256();
+        __m256i pickups[NUM_FLOORS + 1], dropoffs[NUM_FLOORS + 1];
+
+        for (int ff = GROUND_FLOOR; ff <= NUM_FLOORS; ff++)
+        {
+            pickups[ff] = _mm256_setzero_si256();
+            dropoffs[ff] = _mm256_setzero_si256();
+        }
+
+        for (int ii = base; ii < end; ii += 8)
+        {
+            __m256i from = _mm256_loadu_si256((const __m256i*)&start[ii]);
+            __m256i to = _mm256_loadu_si256((const __m256i*)&dest[ii]);
+
+            // valid = both floors strictly between below and above
+            __m256i valid = _mm256_and_si256(
+                _mm256_and_si256(_mm256_cmpgt_epi32(from, below), 
+                                 _mm256_cmpgt_epi32(above, from)),
+                _mm256_and_si256(_mm256_cmpgt_epi32(to, below), 
+                                 _mm256_cmpgt_epi32(above, to)));
+            invalid = _mm256_sub_epi32(invalid, 
+                _mm256_andnot_si256(valid, _mm256_set1_epi32(-1)));
+            same = _mm256_sub_epi32(same, 
+                _mm256_and_si256(valid, _mm256_cmpeq_epi32(from, to)));
+            up = _mm256_sub_epi32(up, 
+                _mm256_and_si256(valid, _mm256_cmpgt_epi32(to, from)));
+            down = _mm256_sub_epi32(down, 
+                _mm256_and_si256(valid, _mm256_cmpgt_epi32(from, to)));
+            trip = _mm256_add_epi32(trip, _mm256_and_si256(valid, 
+                _mm256_abs_epi32(_mm256_sub_epi32(to, from))));
+
+            // Invalid lanes are outside every floor, so never match
+            for (int ff = GROUND_FLOOR; ff <= NUM_FLOORS; ff++)
+            {
+                __m256i floor = _mm256_set1_epi32(ff);
+                pickups[ff] = _mm256_sub_epi32(pickups[ff], 
+                    _mm256_and_si256(valid, _mm256_cmpeq_epi32(from, floor)));
+                dropoffs[ff] = _mm256_sub_epi32(dropoffs[ff], 
+                    _mm256_and_si256(valid, _mm256_cmpeq_epi32(to, floor)));
+            }
+        }
+
+        // Add the lanes up into the totals
+        stats->requests += end - base;
+#define SUM_LANES(vec, total) \
+        _mm256_storeu_si256((__m256i*)lanes, vec); \
+        total += (long long)lanes[0] + lanes[1] + lanes[2] + lanes[3] + \
+                 lanes[4] + lanes[5] + lanes[6] + lanes[7]
+        SUM_LANES(invalid, stats->invalid);
+        SUM_LANES(same, stats->sameFloor);
+        SUM_LANES(up, stats->up);
+        SUM_LANES(down, stats->down);
+        SUM_LANES(trip, stats->tripFloors);
+        for (int ff = GROUND_FLOOR; ff <= NUM_FLOORS; ff++)
+        {
+            SUM_LANES(pickups[ff], stats->pickups[ff]);
+            SUM_LANES(dropoffs[ff], stats->dropoffs[ff]);
+        }
+#undef SUM_LANES
+    }
+
+    analyzeScalar(start + done, dest + done, count - done, stats);
+}
+
+#endif
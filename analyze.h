@@ -0,0 +1,53 @@
+/* ****************************************************************************
+ * FILE:        analyze.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for analyze.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include "lift_sim.h"
+
+#ifndef ANALYZE
+#define ANALYZE
+
+// Lane counters are added into the totals every this many requests, well
+// before a 32-bit lane could overflow
+#define ANALYZE_BLOCK (1 << 16)
+
+// Statistics of a request trace. Only requests whose floors are both in 
+// range count towards anything but 'requests' and 'invalid'.
+// sameFloor = start == destination, up / down = direction of travel
+// tripFloors = floors between start and destination, summed
+// pickups / dropoffs = histograms of start / destination floors
+typedef struct TraceStats
+{
+    long long requests;
+    long long invalid;
+    long long sameFloor;
+    long long up;
+    long long down;
+    long long tripFloors;
+    long long pickups[NUM_FLOORS + 1];
+    long long dropoffs[NUM_FLOORS + 1];
+} TraceStats;
+
+// A kernel adds the stats of count requests, given as separate arrays of
+// start and destination floors, to stats
+typedef void (*AnalyzeKernel)(const int* start, const int* dest, int count,
+                              TraceStats* stats);
+
+#endif
+
+// Prototype Declarations
+int analyzeTrace(char* filename);
+AnalyzeKernel chooseKernel(const char** name);
+void analyzeScalar(const int* start, const int* dest, int count, 
+                   TraceStats* stats);
+#if defined(__x86_64__) || defined(__i386__)
+void analyzeSse2(const int* start, const int* dest, int count, 
+                 TraceStats* stats);
+void analyzeAvx2(const int* start, const int* dest, int count, 
+                 TraceStats* stats);
+#endif
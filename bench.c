@@ -0,0 +1,169 @@
+/* ****************************************************************************
+ * FILE:        bench.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Shared helpers for the benchmark programs: a monotonic clock,
+ *              repeated timing with percentiles, and Linux hardware
+ *              performance counters (perf_event_open).
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include "bench.h"
+
+/* ****************************************************************************
+ * NAME:        benchSeconds
+ * 
+ * PURPOSE:     Returns the current time of the monotonic clock in seconds.
+ * 
+ * EXPORT:      Double seconds
+ * ***************************************************************************/
+double benchSeconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/* ****************************************************************************
+ * NAME:        benchRun
+ * 
+ * PURPOSE:     Run a benchmark body warmup times without timing it, then 
+ *              reps times timing every run, and work out the spread.
+ * 
+ * IMPORT:      body - one repetition
+ *              arg - passed to body
+ *              warmup - untimed runs
+ *              reps - timed runs (>= 1)
+ *              stats - filled in with the timings
+ * ***************************************************************************/
+void benchRun(BenchBody body, void* arg, int warmup, int reps, 
+              BenchStats* stats)
+{
+    double* times = (double*)malloc(sizeof(double) * reps);
+
+    for (int ii = 0; ii < warmup; ii++)
+    {
+        body(arg);
+    }
+
+    for (int ii = 0; ii < reps; ii++)
+    {
+        double start = benchSeconds();
+        body(arg);
+        times[ii] = benchSeconds() - start;
+    }
+
+    // Insertion sort, there are only a handful
+    for (int ii = 1; ii < reps; ii++)
+    {
+        double time = times[ii];
+        int jj = ii - 1;
+        while (jj >= 0 && times[jj] > time)
+        {
+            times[jj + 1] = times[jj];
+            jj--;
+        }
+        times[jj + 1] = time;
+    }
+
+    stats->median = benchPercentile(times, reps, 50.0);
+    stats->p10 = benchPercentile(times, reps, 10.0);
+    stats->p90 = benchPercentile(times, reps, 90.0);
+    stats->min = times[0];
+    stats->max = times[reps - 1];
+
+    free(times);
+}
+
+/* ****************************************************************************
+ * NAME:        benchPercentile
+ * 
+ * PURPOSE:     Returns a percentile of sorted timings, interpolating between
+ *              the two nearest.
+ * 
+ * IMPORT:      sorted - timings, in ascending order
+ *              count - number of timings (>= 1)
+ *              pct - percentile (0 to 100)
+ * EXPORT:      The percentile
+ * ***************************************************************************/
+double benchPercentile(const double* sorted, int count, double pct)
+{
+    double rank = pct / 100.0 * (count - 1);
+    int below = (int)rank;
+    double value = sorted[below];
+
+    if (below + 1 < count)
+    {
+        value += (rank - below) * (sorted[below + 1] - sorted[below]);
+    }
+
+    return value;
+}
+
+/* ****************************************************************************
+ * NAME:        perfStart
+ * 
+ * PURPOSE:     Open and enable a performance counter for the calling thread
+ *              and every thread it creates afterwards.
+ * 
+ * IMPORT:      type - perf event type (e.g. PERF_TYPE_HARDWARE)
+ *              config - perf event (e.g. PERF_COUNT_HW_CACHE_MISSES)
+ * EXPORT:      Counter file descriptor (-1 = counters unavailable)
+ * ***************************************************************************/
+int perfStart(unsigned int type, unsigned long long config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd != -1)
+    {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    return fd;
+}
+
+/* ****************************************************************************
+ * NAME:        perfStop
+ * 
+ * PURPOSE:     Disable, read and close a counter opened by perfStart().
+ *              Counts from inherited threads are only included once those
+ *              threads have been joined.
+ * 
+ * IMPORT:      fd - counter file descriptor
+ * EXPORT:      Counter value (-1 = counters unavailable)
+ * ***************************************************************************/
+long long perfStop(int fd)
+{
+    long long count = -1;
+    if (fd != -1)
+    {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != sizeof(count))
+        {
+            count = -1;
+        }
+        close(fd);
+    }
+
+    return count;
+}
@@ -0,0 +1,43 @@
+/* ****************************************************************************
+ * FILE:        bench.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for bench.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+
+#ifndef BENCH
+#define BENCH
+
+// Linux perf event types/configs accepted by perfStart()
+#include <linux/perf_event.h>
+
+// Untimed runs before measuring (to warm caches, the allocator and the page
+// cache), then timed repetitions
+#define BENCH_WARMUP 2
+#define BENCH_REPS 11
+
+// One repetition of a benchmark
+typedef void (*BenchBody)(void* arg);
+
+// Timings of a benchmark's repetitions, in seconds
+typedef struct BenchStats
+{
+    double median;
+    double p10;
+    double p90;
+    double min;
+    double max;
+} BenchStats;
+
+#endif
+
+// Prototype Declarations
+double benchSeconds(void);
+void benchRun(BenchBody body, void* arg, int warmup, int reps, 
+              BenchStats* stats);
+double benchPercentile(const double* sorted, int count, double pct);
+int perfStart(unsigned int type, unsigned long long config);
+long long perfStop(int fd);
@@ -0,0 +1,221 @@
+/* ****************************************************************************
+ * FILE:        bench_layout.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Benchmark of the cache-line aware layout of lifts and buffer
+ *              indices.
+ *
+ *              Every lift thread hammers its own lift the way move() does,
+ *              first with the lifts packed back to back (the old layout, a
+ *              few lifts per cache line) and then with the cache-aligned
+ *              array from createLifts(). A producer and consumer thread then 
+ *              bump next_in / next_out of the old and the new Buffer layout.
+ *              Hardware cache misses are counted with perf_event_open (shown
+ *              as -1 where the kernel does not allow it).
+ *
+ *              Usage: ./bench_layout <optional_iterations>
+ *
+ * LAST MOD:    19/10/26 
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "lift_sim.h"
+#include "buffer.h"
+#include "building.h"
+#include "bench.h"
+
+#define ITERATIONS 2000000
+#define MAX_BENCH_LIFTS 256
+
+// The lift layout from before lifts were cache-aligned
+typedef struct PackedLift
+{
+    int id;
+    int currFloor;
+    int delay;
+    int numRequests;
+    int numMovements;
+    struct Building* building;
+} PackedLift;
+
+// The buffer layout from before the indices were split across cache lines
+typedef struct PackedBuffer
+{
+    Request** buf;
+    int capacity;
+    unsigned int mask;
+    unsigned int next_in;
+    unsigned int next_out;
+} PackedBuffer;
+
+// Work handed to each benchmark thread
+typedef struct Job
+{
+    volatile int* currFloor;
+    volatile int* numRequests;
+    volatile int* numMovements;
+    volatile unsigned int* index;
+    long iterations;
+} Job;
+
+static void* hammerLift(void* arg);
+static void* hammerIndex(void* arg);
+static void runLifts(const char* layout, Job* jobs, int numLifts);
+static void runIndices(const char* layout, volatile unsigned int* in,
+                       volatile unsigned int* out, long iterations);
+
+int main(int argc, char *argv[])
+{
+    long iterations = ITERATIONS;
+    int counts[] = { 3, 16, 64, MAX_BENCH_LIFTS };
+    Job jobs[MAX_BENCH_LIFTS];
+
+    if (argc > 1 && atol(argv[1]) > 0)
+    {
+        iterations = atol(argv[1]);
+    }
+
+    printf("benchmark,layout,threads,seconds,cache_misses\n");
+
+    for (int cc = 0; cc < (int)(sizeof(counts) / sizeof(counts[0])); cc++)
+    {
+        int numLifts = counts[cc];
+
+        // Old layout: lifts packed back to back
+        PackedLift* packed = (PackedLift*)calloc(numLifts, sizeof(PackedLift));
+        for (int ii = 0; ii < numLifts; ii++)
+        {
+            jobs[ii].currFloor = &packed[ii].currFloor;
+            jobs[ii].numRequests = &packed[ii].numRequests;
+            jobs[ii].numMovements = &packed[ii].numMovements;
+            jobs[ii].iterations = iterations;
+        }
+        runLifts("packed", jobs, numLifts);
+        free(packed);
+
+        // New layout: one lift per cache line
+        Lift* aligned = createLifts(numLifts, 0, NULL);
+        for (int ii = 0; ii < numLifts; ii++)
+        {
+            jobs[ii].currFloor = &aligned[ii].currFloor;
+            jobs[ii].numRequests = &aligned[ii].numRequests;
+            jobs[ii].numMovements = &aligned[ii].numMovements;
+            jobs[ii].iterations = iterations;
+        }
+        runLifts("aligned", jobs, numLifts);
+        free(aligned);
+    }
+
+    PackedBuffer* packedBuf = (PackedBuffer*)calloc(1, sizeof(PackedBuffer));
+    runIndices("packed", &packedBuf->next_in, &packedBuf->next_out, 
+               iterations);
+    free(packedBuf);
+
+    Buffer* alignedBuf = createBuffer(16);
+    runIndices("aligned", &alignedBuf->next_in, &alignedBuf->next_out, 
+               iterations);
+    freeBuffer(alignedBuf);
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        runLifts
+ * 
+ * PURPOSE:     Run one lift thread per job and report time and cache misses.
+ * 
+ * IMPORT:      layout - name of the layout being measured
+ *              jobs - one job per lift
+ *              numLifts - number of jobs
+ * ***************************************************************************/
+static void runLifts(const char* layout, Job* jobs, int numLifts)
+{
+    pthread_t threads[MAX_BENCH_LIFTS];
+
+    int fd = perfStart(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    double start = benchSeconds();
+
+    for (int ii = 0; ii < numLifts; ii++)
+    {
+        pthread_create(&threads[ii], NULL, hammerLift, &jobs[ii]);
+    }
+    for (int ii = 0; ii < numLifts; ii++)
+    {
+        pthread_join(threads[ii], NULL);
+    }
+
+    double elapsed = benchSeconds() - start;
+    long long misses = perfStop(fd);
+
+    printf("lifts,%s,%d,%.4f,%lld\n", layout, numLifts, elapsed, misses);
+}
+
+/* ****************************************************************************
+ * NAME:        runIndices
+ * 
+ * PURPOSE:     Run a producer thread bumping next_in alongside a consumer 
+ *              thread bumping next_out, and report time and cache misses.
+ * 
+ * IMPORT:      layout - name of the layout being measured
+ *              in, out - the two ring indices
+ *              iterations - bumps per thread
+ * ***************************************************************************/
+static void runIndices(const char* layout, volatile unsigned int* in,
+                       volatile unsigned int* out, long iterations)
+{
+    pthread_t producer, consumer;
+    Job jobs[2] = { { NULL, NULL, NULL, in, iterations },
+                    { NULL, NULL, NULL, out, iterations } };
+
+    int fd = perfStart(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    double start = benchSeconds();
+
+    pthread_create(&producer, NULL, hammerIndex, &jobs[0]);
+    pthread_create(&consumer, NULL, hammerIndex, &jobs[1]);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    double elapsed = benchSeconds() - start;
+    long long misses = perfStop(fd);
+
+    printf("indices,%s,2,%.4f,%lld\n", layout, elapsed, misses);
+}
+
+/* ****************************************************************************
+ * NAME:        hammerLift
+ * 
+ * PURPOSE:     Thread body: the lift bookkeeping done per request by lift()
+ *              and move(), without the sleeping.
+ * ***************************************************************************/
+static void* hammerLift(void* arg)
+{
+    Job* job = (Job*)arg;
+    for (long ii = 0; ii < job->iterations; ii++)
+    {
+        int to = (int)(ii % NUM_FLOORS) + GROUND_FLOOR;
+        *job->numRequests += 1;
+        *job->numMovements += abs(*job->currFloor - to);
+        *job->currFloor = to;
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        hammerIndex
+ * 
+ * PURPOSE:     Thread body: advance a ring index as addToBuffer() and 
+ *              popBuffer() do.
+ * ***************************************************************************/
+static void* hammerIndex(void* arg)
+{
+    Job* job = (Job*)arg;
+    for (long ii = 0; ii < job->iterations; ii++)
+    {
+        *job->index += 1;
+    }
+
+    return 0;
+}
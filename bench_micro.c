@@ -0,0 +1,1018 @@
+/* ****************************************************************************
+ * FILE:        bench_micro.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Micro-benchmarks of the primitives every request goes
+ *              through: the buffer (alone, then shared by a producer and
+ *              1 to MAX_BENCH_THREADS - 1 consumers under a lock, as in A,
+ *              then by 1 to MAX_BENCH_THREADS / 2 producers numbering the 
+ *              requests they add and one consumer, as with --producers),
+ *              the linked list, parsing the input file, rendering log 
+ *              entries (with snprintf as before, and with render.c) and
+ *              writing the log (a few records, then a large run through 
+ *              stdio and through the batched backend, --output-backend
+ *              batch), and replaying the simulated policy (--solve) with the
+ *              generic kernel against the specialised ones. A dispatch 
+ *              benchmark finds the nearest call in a lift's direction at
+ *              256 and 1024 floors, by scanning the buffer and by the hall
+ *              call bitmaps.
+ *              A handoff benchmark passes one request back and forth between
+ *              two threads, unpinned and pinned to the same CPU, two CPUs of
+ *              the same NUMA node and two nodes (where there are any), to
+ *              show what --pin and --cpus are worth.
+ *
+ *              Every benchmark is warmed up, then timed over BENCH_REPS
+ *              repetitions. The median, 10th and 90th percentile, min and
+ *              max time per operation are printed, and appended to a CSV
+ *              results file along with a label (e.g. a version), so runs can
+ *              be compared across versions.
+ *
+ *              Usage: ./bench_micro <optional_results.csv> <optional_label>
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "lift_sim.h"
+#include "linked_list.h"
+#include "buffer.h"
+#include "fileio.h"
+#include "building.h"
+#include "bench.h"
+#include "topology.h"
+#include "replay.h"
+#include "hall_calls.h"
+#include "output.h"
+#include "render.h"
+
+#define BENCH_RESULTS "bench_results.csv"
+#define BENCH_BUFFER 16
+#define BUFFERS_CREATED 4096
+#define BUFFER_ITEMS (1 << 17)
+#define LIST_ITEMS (1 << 17)
+#define PARSE_LINES 200000
+#define WRITE_RECORDS 2000
+#define LARGE_RECORDS (1 << 16)
+#define FORMAT_EVENTS (1 << 17)
+#define MAX_BENCH_THREADS 8
+#define HANDOFF_ROUNDS 20000
+#define REPLAY_REQUESTS (1 << 17)
+#define DISPATCH_QUERIES (1 << 14)
+
+// A buffer shared by a number of producers and consumers, the way A's
+// request() and lift() threads share a building's buffer
+// remaining = requests not yet popped, nextNum = number of the last request
+// added (by any producer)
+// logging = 1 for producers to log every request as request() does, with
+// reserved = slots reserved for requests not yet added, logged = requests
+// numbered and logged (under logLock, into sink)
+typedef struct SharedBuffer
+{
+    Buffer* buf;
+    Request* pool;
+    long items;
+    long remaining;
+    long nextNum;
+    int numThreads;
+    int numProducers;
+    int logging;
+    long reserved;
+    long logged;
+    char sink[EVENT_LEN];
+    pthread_mutex_t lock;
+    pthread_cond_t notFull;
+    pthread_cond_t notEmpty;
+    pthread_mutex_t logLock;
+} SharedBuffer;
+
+// One request passed from a ping thread to a pong thread and back, each
+// pinned to a CPU (-1 = not pinned)
+typedef struct Handoff
+{
+    Buffer* there;
+    Buffer* back;
+    Request req;
+    int cpus[2];
+    long rounds;
+    pthread_mutex_t lock;
+    pthread_cond_t moved;
+} Handoff;
+
+// A replay run by one kernel
+typedef struct ReplayRun
+{
+    Replay* replay;
+    ReplayKernel kernel;
+    int numLifts;
+} ReplayRun;
+
+// Waiting calls, in a buffer and indexed by floor, and the lift positions
+// and directions to find the nearest call for
+typedef struct Dispatch
+{
+    Buffer* buf;
+    HallCalls* calls;
+    int floors[DISPATCH_QUERIES];
+    int dirs[DISPATCH_QUERIES];
+    long long found;
+} Dispatch;
+
+// Lift operations logged to an output file by the output in use
+typedef struct LogRun
+{
+    OutFile outFile;
+    int records;
+} LogRun;
+
+// Log entries rendered (bytes = their total length, so none are skipped)
+typedef struct FormatRun
+{
+    long long bytes;
+} FormatRun;
+
+// Where the results go
+typedef struct Report
+{
+    FILE* results;
+    const char* label;
+    char date[32];
+} Report;
+
+static void createBuffers(void* arg);
+static void fillBuffer(void* arg);
+static void shareBuffer(void* arg);
+static void* produce(void* arg);
+static void* ingest(void* arg);
+static void* consume(void* arg);
+static void handoff(void* arg);
+static void* ping(void* arg);
+static void* pong(void* arg);
+static int findCpu(const Topology* topo, int cpu, int sameNode);
+static void replayRequests(void* arg);
+static void benchDispatch(Report* rep, int numFloors, int numCalls);
+static void scanNearest(void* arg);
+static void bitmapNearest(void* arg);
+static void fillList(void* arg);
+static void parseFile(void* arg);
+static void snprintfEvents(void* arg);
+static void renderEvents(void* arg);
+static int snprintfLiftActivity(char* out, int size, Lift* lift, 
+                                Request* req);
+static void writeLog(void* arg);
+static void report(Report* rep, const char* name, int threads, long ops,
+                   BenchStats* stats);
+
+int main(int argc, char *argv[])
+{
+    Report rep;
+    BenchStats stats;
+    SharedBuffer shared;
+    Handoff hand;
+    Topology topo;
+    ReplayRun run;
+    char inFile[] = "/tmp/bench_micro_in_XXXXXX";
+    char outFile[] = "/tmp/bench_micro_out_XXXXXX";
+    const char* path = (argc > 1) ? argv[1] : BENCH_RESULTS;
+    time_t now = time(NULL);
+
+    rep.label = (argc > 2) ? argv[2] : "-";
+    strftime(rep.date, sizeof(rep.date), "%Y-%m-%d %H:%M:%S",
+             localtime(&now));
+    rep.results = fopen(path, "a");
+    if (rep.results == NULL)
+    {
+        perror("there was an error opening the results file");
+    }
+    else
+    {
+        // A new results file gets the header
+        if (ftell(rep.results) == 0)
+        {
+            fprintf(rep.results, "date,label,benchmark,threads,ops,median_ns,"
+                    "p10_ns,p90_ns,min_ns,max_ns,ops_per_s\n");
+        }
+        printf("benchmark,threads,ops,median_ns,p10_ns,p90_ns,min_ns,max_ns,"
+               "ops_per_s\n");
+
+        // BUFFER
+        benchRun(createBuffers, NULL, BENCH_WARMUP, BENCH_REPS, &stats);
+        report(&rep, "createBuffer", 1, BUFFERS_CREATED, &stats);
+
+        shared.pool = (Request*)calloc(BENCH_BUFFER, sizeof(Request));
+        shared.buf = createBuffer(BENCH_BUFFER);
+        shared.items = BUFFER_ITEMS;
+        shared.logging = 0;
+        pthread_mutex_init(&shared.lock, NULL);
+        pthread_cond_init(&shared.notFull, NULL);
+        pthread_cond_init(&shared.notEmpty, NULL);
+        pthread_mutex_init(&shared.logLock, NULL);
+
+        benchRun(fillBuffer, &shared, BENCH_WARMUP, BENCH_REPS, &stats);
+        report(&rep, "addToBuffer+popBuffer", 1, BUFFER_ITEMS, &stats);
+
+        shared.numProducers = 1;
+        for (int ii = 2; ii <= MAX_BENCH_THREADS; ii *= 2)
+        {
+            shared.numThreads = ii;
+            benchRun(shareBuffer, &shared, BENCH_WARMUP, BENCH_REPS, &stats);
+            report(&rep, "addToBuffer+popBuffer", ii, BUFFER_ITEMS, &stats);
+        }
+
+        // Ingest throughput by number of producers, logging as they go
+        shared.logging = 1;
+        for (int ii = 1; ii <= MAX_BENCH_THREADS / 2; ii *= 2)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "ingest %d producer%s", ii, 
+                     ii == 1 ? "" : "s");
+            shared.numProducers = ii;
+            shared.numThreads = ii + 1;
+            benchRun(shareBuffer, &shared, BENCH_WARMUP, BENCH_REPS, &stats);
+            report(&rep, name, ii + 1, BUFFER_ITEMS, &stats);
+        }
+
+        pthread_mutex_destroy(&shared.lock);
+        pthread_cond_destroy(&shared.notFull);
+        pthread_cond_destroy(&shared.notEmpty);
+        pthread_mutex_destroy(&shared.logLock);
+        freeBuffer(shared.buf); // empty, so the pool isn't freed with it
+        free(shared.pool);
+
+        // HANDOFF
+        hand.there = createBuffer(1);
+        hand.back = createBuffer(1);
+        hand.rounds = HANDOFF_ROUNDS;
+        pthread_mutex_init(&hand.lock, NULL);
+        pthread_cond_init(&hand.moved, NULL);
+
+        hand.cpus[0] = -1;
+        hand.cpus[1] = -1;
+        benchRun(handoff, &hand, BENCH_WARMUP, BENCH_REPS, &stats);
+        report(&rep, "handoff unpinned", 2, 2 * HANDOFF_ROUNDS, &stats);
+
+        if (readTopology(NULL, &topo) == 0)
+        {
+            const char* names[] = { "handoff same cpu", "handoff same node",
+                                    "handoff cross node" };
+            hand.cpus[0] = topo.cpus[0];
+            for (int ii = 0; ii < 3; ii++)
+            {
+                hand.cpus[1] = findCpu(&topo, hand.cpus[0], 2 - ii);
+                if (hand.cpus[1] == -1)
+                {
+                    fprintf(stderr, "%s: skipped, no such cpu\n", names[ii]);
+                }
+                else
+                {
+                    benchRun(handoff, &hand, BENCH_WARMUP, BENCH_REPS, &stats);
+                    report(&rep, names[ii], 2, 2 * HANDOFF_ROUNDS, &stats);
+                }
+            }
+        }
+
+        pthread_mutex_destroy(&hand.lock);
+        pthread_cond_destroy(&hand.moved);
+        freeBuffer(hand.there); // empty, req is on the stack
+        freeBuffer(hand.back);
+
+        // REPLAY
+        LinkedList* requests = createLinkedList();
+        TravelModel travel = { 3, 5, 2, 1 };
+        srand(1);
+        for (int ii = 0; ii < REPLAY_REQUESTS; ii++)
+        {
+            Request* req = (Request*)calloc(1, sizeof(Request));
+            req->start = rand() % NUM_FLOORS + 1;
+            req->destination = rand() % NUM_FLOORS + 1;
+            req->building = 1;
+            insertLast(requests, req);
+        }
+        run.replay = createReplay(requests, 1, 0, &travel);
+        freeLinkedList(requests);
+
+        int lifts[] = { NUM_LIFTS, MAX_SPECIALISED_LIFTS };
+        for (int ii = 0; ii < 2; ii++)
+        {
+            char name[48];
+            run.numLifts = lifts[ii];
+
+            run.kernel = replayGeneric;
+            snprintf(name, sizeof(name), "replay generic %d lifts", lifts[ii]);
+            benchRun(replayRequests, &run, BENCH_WARMUP, BENCH_REPS, &stats);
+            report(&rep, name, 1, REPLAY_REQUESTS, &stats);
+
+            run.kernel = replayKernel(lifts[ii]);
+            snprintf(name, sizeof(name), "replay specialised %d lifts", 
+                     lifts[ii]);
+            benchRun(replayRequests, &run, BENCH_WARMUP, BENCH_REPS, &stats);
+            report(&rep, name, 1, REPLAY_REQUESTS, &stats);
+        }
+        freeReplay(run.replay);
+
+        // DISPATCH
+        for (int floors = 256; floors <= 1024; floors *= 4)
+        {
+            benchDispatch(&rep, floors, 16);
+            benchDispatch(&rep, floors, 1024);
+        }
+
+        // LIST
+        benchRun(fillList, NULL, BENCH_WARMUP, BENCH_REPS, &stats);
+        report(&rep, "insertLast+removeStart", 1, LIST_ITEMS, &stats);
+
+        // FORMATTING
+        FormatRun fmt = { 0 };
+        benchRun(snprintfEvents, &fmt, BENCH_WARMUP, BENCH_REPS, &stats);
+        report(&rep, "format snprintf", 1, FORMAT_EVENTS, &stats);
+
+        benchRun(renderEvents, &fmt, BENCH_WARMUP, BENCH_REPS, &stats);
+        report(&rep, "format render", 1, FORMAT_EVENTS, &stats);
+
+        // FILE I/O
+        int fd = mkstemp(inFile);
+        FILE* file = (fd == -1) ? NULL : fdopen(fd, "w");
+        if (file == NULL)
+        {
+            perror("there was an error creating the input file");
+        }
+        else
+        {
+            srand(1);
+            for (int ii = 0; ii < PARSE_LINES; ii++)
+            {
+                fprintf(file, "%d %d\n", rand() % NUM_FLOORS + 1,
+                        rand() % NUM_FLOORS + 1);
+            }
+            fclose(file);
+
+            benchRun(parseFile, inFile, BENCH_WARMUP, BENCH_REPS, &stats);
+            report(&rep, "readRequests", 1, PARSE_LINES, &stats);
+            remove(inFile);
+        }
+
+        fd = mkstemp(outFile);
+        if (fd == -1)
+        {
+            perror("there was an error creating the output file");
+        }
+        else
+        {
+            close(fd);
+            LogRun logRun = { { "", NULL }, WRITE_RECORDS };
+            snprintf(logRun.outFile.name, OUT_NAME_LEN, "%s", outFile);
+            selectOutput(OUTPUT_PROSE, 1, BACKEND_STDIO);
+            benchRun(writeLog, &logRun, BENCH_WARMUP, BENCH_REPS, &stats);
+            report(&rep, "writeLiftActivity", 1, WRITE_RECORDS, &stats);
+
+            logRun.records = LARGE_RECORDS;
+            benchRun(writeLog, &logRun, BENCH_WARMUP, BENCH_REPS, &stats);
+            report(&rep, "log large stdio", 1, LARGE_RECORDS, &stats);
+
+            selectOutput(OUTPUT_PROSE, 1, BACKEND_BATCH);
+            benchRun(writeLog, &logRun, BENCH_WARMUP, BENCH_REPS, &stats);
+            report(&rep, "log large batch", 1, LARGE_RECORDS, &stats);
+            remove(outFile);
+        }
+
+        fclose(rep.results);
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        createBuffers
+ *
+ * PURPOSE:     Benchmark body: create and free BUFFERS_CREATED buffers.
+ * ***************************************************************************/
+static void createBuffers(void* arg)
+{
+    for (int ii = 0; ii < BUFFERS_CREATED; ii++)
+    {
+        Buffer* buf = createBuffer(BENCH_BUFFER);
+        freeBuffer(buf);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        fillBuffer
+ *
+ * PURPOSE:     Benchmark body: fill the buffer and empty it again, on one
+ *              thread with no lock, until every request has been through.
+ *
+ * IMPORT:      Pointer to the shared buffer
+ * ***************************************************************************/
+static void fillBuffer(void* arg)
+{
+    SharedBuffer* shared = (SharedBuffer*)arg;
+    long added = 0;
+
+    while (added < shared->items)
+    {
+        while (!isFull(shared->buf) && added < shared->items)
+        {
+            addToBuffer(shared->buf, &shared->pool[added % BENCH_BUFFER]);
+            added++;
+        }
+        while (popBuffer(shared->buf) != NULL);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        shareBuffer
+ *
+ * PURPOSE:     Benchmark body: numProducers producer threads and the rest
+ *              of the numThreads consumer threads pass every request through
+ *              the buffer.
+ *
+ * IMPORT:      Pointer to the shared buffer
+ * ***************************************************************************/
+static void shareBuffer(void* arg)
+{
+    SharedBuffer* shared = (SharedBuffer*)arg;
+    pthread_t threads[MAX_BENCH_THREADS];
+
+    shared->remaining = shared->items;
+    shared->nextNum = 0;
+    shared->reserved = 0;
+    shared->logged = 0;
+    for (int ii = 0; ii < shared->numThreads; ii++)
+    {
+        if (ii >= shared->numProducers)
+        {
+            pthread_create(&threads[ii], NULL, consume, shared);
+        }
+        else
+        {
+            pthread_create(&threads[ii], NULL, 
+                           shared->logging ? ingest : produce, shared);
+        }
+    }
+    for (int ii = 0; ii < shared->numThreads; ii++)
+    {
+        pthread_join(threads[ii], NULL);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        produce
+ *
+ * PURPOSE:     Thread body: add this producer's share of the requests to
+ *              the buffer, numbering each as it goes in, as request() does
+ *              in A.
+ *
+ * IMPORT:      Pointer to the shared buffer (items divide evenly between
+ *              the producers)
+ * ***************************************************************************/
+static void* produce(void* arg)
+{
+    SharedBuffer* shared = (SharedBuffer*)arg;
+
+    for (long ii = 0; ii < shared->items / shared->numProducers; ii++)
+    {
+        pthread_mutex_lock(&shared->lock);
+        while (isFull(shared->buf))
+        {
+            pthread_cond_wait(&shared->notFull, &shared->lock);
+        }
+        Request* req = &shared->pool[shared->nextNum % BENCH_BUFFER];
+        req->num = (int)++shared->nextNum;
+        addToBuffer(shared->buf, req);
+        pthread_cond_signal(&shared->notEmpty);
+        pthread_mutex_unlock(&shared->lock);
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        ingest
+ *
+ * PURPOSE:     Thread body: add this producer's share of the requests to
+ *              the buffer as request() does in A. Its slot is reserved 
+ *              under the lock, then it is numbered and its CSV row rendered
+ *              into the sink under the log lock (as the batched output 
+ *              renders into its page), then it is added under the lock.
+ *
+ * IMPORT:      Pointer to the shared buffer (items divide evenly between
+ *              the producers)
+ * ***************************************************************************/
+static void* ingest(void* arg)
+{
+    SharedBuffer* shared = (SharedBuffer*)arg;
+    Request req = { 0, 5, 12, 1, 0, 0 };
+
+    for (long ii = 0; ii < shared->items / shared->numProducers; ii++)
+    {
+        pthread_mutex_lock(&shared->lock);
+        while ((long)(shared->buf->next_in - shared->buf->next_out) + 
+               shared->reserved >= BENCH_BUFFER)
+        {
+            pthread_cond_wait(&shared->notFull, &shared->lock);
+        }
+        shared->reserved++;
+        pthread_mutex_unlock(&shared->lock);
+
+        pthread_mutex_lock(&shared->logLock);
+        long num = ++shared->logged;
+        req.num = (int)num;
+        renderRequestCsv(shared->sink, &req);
+        pthread_mutex_unlock(&shared->logLock);
+
+        pthread_mutex_lock(&shared->lock);
+        addToBuffer(shared->buf, &shared->pool[num % BENCH_BUFFER]);
+        shared->reserved--;
+        pthread_cond_signal(&shared->notEmpty);
+        pthread_mutex_unlock(&shared->lock);
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        consume
+ *
+ * PURPOSE:     Thread body: pop requests until all have been popped, as
+ *              lift() does in A (without serving them).
+ *
+ * IMPORT:      Pointer to the shared buffer
+ * ***************************************************************************/
+static void* consume(void* arg)
+{
+    SharedBuffer* shared = (SharedBuffer*)arg;
+    int done = 0;
+
+    while (!done)
+    {
+        pthread_mutex_lock(&shared->lock);
+        while (isEmpty(shared->buf) && shared->remaining > 0)
+        {
+            pthread_cond_wait(&shared->notEmpty, &shared->lock);
+        }
+
+        if (shared->remaining == 0)
+        {
+            done = 1;
+        }
+        else
+        {
+            popBuffer(shared->buf);
+            shared->remaining--;
+            if (shared->remaining == 0)
+            {
+                // Release other consumers stuck waiting
+                pthread_cond_broadcast(&shared->notEmpty);
+            }
+            pthread_cond_signal(&shared->notFull);
+        }
+        pthread_mutex_unlock(&shared->lock);
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        handoff
+ *
+ * PURPOSE:     Benchmark body: a ping and a pong thread pass one request
+ *              back and forth rounds times, through a buffer each way under
+ *              one lock, the way a request goes from Lift-R to a lift in A.
+ *
+ * IMPORT:      Pointer to the handoff
+ * ***************************************************************************/
+static void handoff(void* arg)
+{
+    Handoff* hand = (Handoff*)arg;
+    pthread_t threads[2];
+
+    pthread_create(&threads[0], NULL, ping, hand);
+    pthread_create(&threads[1], NULL, pong, hand);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+}
+
+/* ****************************************************************************
+ * NAME:        ping
+ *
+ * PURPOSE:     Thread body: send the request, then wait for it to come back.
+ *
+ * IMPORT:      Pointer to the handoff
+ * ***************************************************************************/
+static void* ping(void* arg)
+{
+    Handoff* hand = (Handoff*)arg;
+
+    if (hand->cpus[0] != -1)
+    {
+        pinSelf(hand->cpus[0]);
+    }
+
+    pthread_mutex_lock(&hand->lock);
+    for (long ii = 0; ii < hand->rounds; ii++)
+    {
+        addToBuffer(hand->there, &hand->req);
+        pthread_cond_broadcast(&hand->moved);
+        while (isEmpty(hand->back))
+        {
+            pthread_cond_wait(&hand->moved, &hand->lock);
+        }
+        popBuffer(hand->back);
+    }
+    pthread_mutex_unlock(&hand->lock);
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        pong
+ *
+ * PURPOSE:     Thread body: wait for the request, then send it back.
+ *
+ * IMPORT:      Pointer to the handoff
+ * ***************************************************************************/
+static void* pong(void* arg)
+{
+    Handoff* hand = (Handoff*)arg;
+
+    if (hand->cpus[1] != -1)
+    {
+        pinSelf(hand->cpus[1]);
+    }
+
+    pthread_mutex_lock(&hand->lock);
+    for (long ii = 0; ii < hand->rounds; ii++)
+    {
+        while (isEmpty(hand->there))
+        {
+            pthread_cond_wait(&hand->moved, &hand->lock);
+        }
+        addToBuffer(hand->back, popBuffer(hand->there));
+        pthread_cond_broadcast(&hand->moved);
+    }
+    pthread_mutex_unlock(&hand->lock);
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        findCpu
+ *
+ * PURPOSE:     Find a CPU to pair with another for the handoff.
+ *
+ * IMPORT:      topo - the topology
+ *              cpu - the other CPU
+ *              sameNode - 2 = the same CPU, 1 = another on its node,
+ *                         0 = one on another node
+ * EXPORT:      CPU number (-1 = there is none)
+ * ***************************************************************************/
+static int findCpu(const Topology* topo, int cpu, int sameNode)
+{
+    int found = (sameNode == 2) ? cpu : -1;
+
+    for (int ii = 0; ii < topo->numCpus && found == -1; ii++)
+    {
+        int other = topo->cpus[ii];
+        if (other != cpu &&
+            (topo->nodeOf[other] == topo->nodeOf[cpu]) == sameNode)
+        {
+            found = other;
+        }
+    }
+
+    return found;
+}
+
+/* ****************************************************************************
+ * NAME:        replayRequests
+ *
+ * PURPOSE:     Benchmark body: replay every request with one kernel.
+ *
+ * IMPORT:      Pointer to the replay run
+ * ***************************************************************************/
+static void replayRequests(void* arg)
+{
+    ReplayRun* run = (ReplayRun*)arg;
+    run->kernel(run->replay, run->numLifts);
+}
+
+/* ****************************************************************************
+ * NAME:        benchDispatch
+ *
+ * PURPOSE:     Time finding the nearest call in a lift's direction, for
+ *              random lift positions and directions, with random calls
+ *              waiting: by scanning the buffer, then by the bitmaps.
+ *
+ * IMPORT:      rep - where the results go
+ *              numFloors - floors in the building
+ *              numCalls - calls waiting
+ * ***************************************************************************/
+static void benchDispatch(Report* rep, int numFloors, int numCalls)
+{
+    BenchStats stats;
+    char name[64];
+    Dispatch* disp = (Dispatch*)malloc(sizeof(Dispatch));
+    Request* pool = (Request*)calloc(numCalls, sizeof(Request));
+
+    disp->buf = createBuffer(numCalls);
+    disp->calls = createHallCalls(numFloors);
+    srand(1);
+    for (int ii = 0; ii < numCalls; ii++)
+    {
+        pool[ii].num = ii + 1;
+        pool[ii].start = rand() % numFloors + 1;
+        pool[ii].destination = rand() % numFloors + 1;
+        addToBuffer(disp->buf, &pool[ii]);
+        addCall(disp->calls, &pool[ii]);
+    }
+    for (int ii = 0; ii < DISPATCH_QUERIES; ii++)
+    {
+        disp->floors[ii] = rand() % numFloors + 1;
+        disp->dirs[ii] = rand() % 2;
+    }
+
+    snprintf(name, sizeof(name), "dispatch scan %d floors %d calls", 
+             numFloors, numCalls);
+    benchRun(scanNearest, disp, BENCH_WARMUP, BENCH_REPS, &stats);
+    report(rep, name, 1, DISPATCH_QUERIES, &stats);
+    long long scanned = disp->found;
+
+    snprintf(name, sizeof(name), "dispatch bitmap %d floors %d calls", 
+             numFloors, numCalls);
+    benchRun(bitmapNearest, disp, BENCH_WARMUP, BENCH_REPS, &stats);
+    report(rep, name, 1, DISPATCH_QUERIES, &stats);
+
+    if (scanned != disp->found)
+    {
+        fprintf(stderr, "dispatch: the scan and the bitmaps disagree\n");
+    }
+
+    while (popBuffer(disp->buf) != NULL);
+    freeBuffer(disp->buf);
+    freeHallCalls(disp->calls);
+    free(pool);
+    free(disp);
+}
+
+/* ****************************************************************************
+ * NAME:        scanNearest
+ *
+ * PURPOSE:     Benchmark body: find each nearest call by looking at every
+ *              request in the buffer.
+ *
+ * IMPORT:      Pointer to the dispatch
+ * ***************************************************************************/
+static void scanNearest(void* arg)
+{
+    Dispatch* disp = (Dispatch*)arg;
+    Buffer* buf = disp->buf;
+
+    disp->found = 0;
+    for (int ii = 0; ii < DISPATCH_QUERIES; ii++)
+    {
+        int floor = disp->floors[ii], dir = disp->dirs[ii];
+        int best = -1;
+        for (unsigned int jj = buf->next_out; jj != buf->next_in; jj++)
+        {
+            Request* req = buf->buf[jj & buf->mask];
+            int start = req->start;
+            if (callDirection(req) == dir &&
+                (dir == CALL_UP ? start >= floor : start <= floor) &&
+                (best == -1 || abs(start - floor) < abs(best - floor)))
+            {
+                best = start;
+            }
+        }
+        disp->found += best;
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        bitmapNearest
+ *
+ * PURPOSE:     Benchmark body: find each nearest call with a bit-scan.
+ *
+ * IMPORT:      Pointer to the dispatch
+ * ***************************************************************************/
+static void bitmapNearest(void* arg)
+{
+    Dispatch* disp = (Dispatch*)arg;
+
+    disp->found = 0;
+    for (int ii = 0; ii < DISPATCH_QUERIES; ii++)
+    {
+        disp->found += nearestCall(disp->calls, disp->floors[ii], 
+                                   disp->dirs[ii]);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        fillList
+ *
+ * PURPOSE:     Benchmark body: append LIST_ITEMS requests to a list, then
+ *              take them all off the front again.
+ * ***************************************************************************/
+static void fillList(void* arg)
+{
+    Request req;
+    LinkedList* list = createLinkedList();
+
+    for (int ii = 0; ii < LIST_ITEMS; ii++)
+    {
+        insertLast(list, &req);
+    }
+    while (removeStart(list) != NULL);
+
+    free(list);
+}
+
+/* ****************************************************************************
+ * NAME:        parseFile
+ *
+ * PURPOSE:     Benchmark body: read every request of the input file.
+ *
+ * IMPORT:      Name of the input file
+ * ***************************************************************************/
+static void parseFile(void* arg)
+{
+    LinkedList* list = createLinkedList();
+    readRequests((char*)arg, list, GROUND_FLOOR, NUM_FLOORS);
+    freeLinkedList(list);
+}
+
+/* ****************************************************************************
+ * NAME:        snprintfEvents, renderEvents
+ *
+ * PURPOSE:     Benchmark bodies: render FORMAT_EVENTS requests and lift 
+ *              operations into a buffer, the old way with snprintf and then
+ *              with render.c.
+ *
+ * IMPORT:      Pointer to the run
+ * ***************************************************************************/
+static void snprintfEvents(void* arg)
+{
+    FormatRun* fmt = (FormatRun*)arg;
+    char text[EVENT_LEN];
+    Lift lift;
+    Request req = { 1, 5, 12, 1, 0, 0 };
+    memset(&lift, 0, sizeof(Lift));
+    lift.id = 1;
+
+    fmt->bytes = 0;
+    for (int ii = 0; ii < FORMAT_EVENTS; ii++)
+    {
+        req.num = ii + 1;
+        req.start = ii % NUM_FLOORS + 1;
+        req.destination = (ii * 7) % NUM_FLOORS + 1;
+        lift.numRequests = ii + 1;
+        lift.numMovements = ii * 9;
+        lift.currFloor = (ii * 3) % NUM_FLOORS + 1;
+
+        fmt->bytes += snprintf(text, EVENT_LEN,
+                               "------------------------------------------\n"
+                               "New Lift Request From Floor %d to Floor %d\n"
+                               "Request No: %d\n"
+                               "------------------------------------------\n"
+                               "\n", req.start, req.destination, req.num);
+        fmt->bytes += snprintfLiftActivity(text, EVENT_LEN, &lift, &req);
+    }
+}
+
+static void renderEvents(void* arg)
+{
+    FormatRun* fmt = (FormatRun*)arg;
+    char text[EVENT_LEN];
+    Lift lift;
+    Request req = { 1, 5, 12, 1, 0, 0 };
+    memset(&lift, 0, sizeof(Lift));
+    lift.id = 1;
+
+    fmt->bytes = 0;
+    for (int ii = 0; ii < FORMAT_EVENTS; ii++)
+    {
+        req.num = ii + 1;
+        req.start = ii % NUM_FLOORS + 1;
+        req.destination = (ii * 7) % NUM_FLOORS + 1;
+        lift.numRequests = ii + 1;
+        lift.numMovements = ii * 9;
+        lift.currFloor = (ii * 3) % NUM_FLOORS + 1;
+
+        fmt->bytes += renderRequest(text, &req);
+        fmt->bytes += renderLiftActivity(text, &lift, &req);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        snprintfLiftActivity
+ *
+ * PURPOSE:     A lift operation's prose entry as it was written before 
+ *              render.c, one printf call per line (the baseline for 
+ *              renderLiftActivity).
+ *
+ * IMPORT:      out - the buffer
+ *              size - its size
+ *              Pointer to the lift struct
+ *              Pointer to the request
+ * EXPORT:      Length of the entry
+ * ***************************************************************************/
+static int snprintfLiftActivity(char* out, int size, Lift* lift, 
+                                Request* req)
+{
+    int numMov = (abs(lift->currFloor - req->start)) + 
+                 (abs(req->start - req->destination));
+    int len = 0;
+
+    len += snprintf(out + len, size - len, "Lift-%d Operation\n", lift->id);
+    len += snprintf(out + len, size - len, "Previous position: Floor %d\n",
+                    lift->currFloor);
+    len += snprintf(out + len, size - len, "Request: Floor %d to %d\n",
+                    req->start, req->destination);
+    len += snprintf(out + len, size - len, "Detail operations:\n");
+    if (lift->currFloor != req->start)
+    {
+        len += snprintf(out + len, size - len, 
+                        "    Go from Floor %d to Floor %d\n",
+                        lift->currFloor, req->start);
+    }
+    len += snprintf(out + len, size - len, "    Go from Floor %d to Floor %d\n",
+                    req->start, req->destination);
+    len += snprintf(out + len, size - len, 
+                    "    #movements for this request: %d\n", numMov);
+    len += snprintf(out + len, size - len, "    #request: %d\n",
+                    lift->numRequests);
+    len += snprintf(out + len, size - len, "    Total #movement: %d\n",
+                    lift->numMovements + numMov);
+    len += snprintf(out + len, size - len, "Current position: Floor %d\n",
+                    req->destination);
+    len += snprintf(out + len, size - len, "\n");
+
+    return len;
+}
+
+/* ****************************************************************************
+ * NAME:        writeLog
+ *
+ * PURPOSE:     Benchmark body: log a number of lift operations to a fresh
+ *              output file, the way lifts do, through the output in use
+ *              (timed until they are all in the file).
+ *
+ * IMPORT:      Pointer to the run
+ * ***************************************************************************/
+static void writeLog(void* arg)
+{
+    LogRun* run = (LogRun*)arg;
+    Lift* lift = createLifts(1, 0, NULL);
+    Request req = { 1, 5, 12, 1, 0, 0 };
+
+    if (truncate(run->outFile.name, 0) == -1)
+    {
+        perror("there was an error emptying the output file");
+    }
+
+    simOutput->open(&run->outFile);
+    for (int ii = 0; ii < run->records; ii++)
+    {
+        lift->numRequests++;
+        simOutput->activity(lift, &req, &run->outFile);
+        lift->numMovements += abs(lift->currFloor - req.start) +
+                              abs(req.start - req.destination);
+        lift->currFloor = req.destination;
+        req.start = ii % NUM_FLOORS + 1;
+        req.destination = (ii * 7) % NUM_FLOORS + 1;
+    }
+    simOutput->close(&run->outFile);
+
+    free(lift);
+}
+
+/* ****************************************************************************
+ * NAME:        report
+ *
+ * PURPOSE:     Print a benchmark's timings per operation, and append them to
+ *              the results file.
+ *
+ * IMPORT:      rep - where the results go
+ *              name - benchmark
+ *              threads - number of threads
+ *              ops - operations per repetition
+ *              stats - timings of the repetitions
+ * ***************************************************************************/
+static void report(Report* rep, const char* name, int threads, long ops,
+                   BenchStats* stats)
+{
+    char row[256];
+
+    snprintf(row, sizeof(row), "%s,%d,%ld,%.1f,%.1f,%.1f,%.1f,%.1f,%.0f\n",
+             name, threads, ops, stats->median * 1e9 / ops,
+             stats->p10 * 1e9 / ops, stats->p90 * 1e9 / ops,
+             stats->min * 1e9 / ops, stats->max * 1e9 / ops,
+             stats->median > 0 ? ops / stats->median : 0.0);
+
+    printf("%s", row);
+    fprintf(rep->results, "%s,%s,%s", rep->date, rep->label, row);
+}
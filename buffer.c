@@ -6,8 +6,9 @@
  * PURPOSE:     For manipulating the state of the buffer -- a structure used
  *              to and manage access to requests.
  *
- * LAST MOD:    14/04/20
+ * LAST MOD:    19/10/26
  * ***************************************************************************/
+#define _POSIX_C_SOURCE 200112L
 #include <stdio.h>
 #include <stdlib.h>
 #include "buffer.h"
@@ -16,25 +17,39 @@
 /* ****************************************************************************
  * NAME:        createBuffer
  * 
- * PURPOSE:     To generate an empty buffer
+ * PURPOSE:     To generate an empty buffer. The slots are rounded up to a
+ *              power of two so a count finds its slot with a mask, but the
+ *              buffer is still full at exactly size requests.
  * 
- * EXPORT:      pointer to the buffer struct
+ * EXPORT:      pointer to the buffer struct (NULL if size is below 1 or above
+ *              BUFFER_MAX_SIZE, or the slots can't be allocated)
  * ***************************************************************************/
 Buffer* createBuffer(int size)
 {
     Buffer* newBuf = NULL;
-    if (size >= 1)
+    void* mem = NULL;
+
+    // Aligned so the producer and consumer indices keep their own cache lines
+    if (size >= 1 && size <= BUFFER_MAX_SIZE &&
+        posix_memalign(&mem, CACHE_LINE, sizeof(Buffer)) == 0)
     {
-        newBuf = (Buffer*)malloc(sizeof(Buffer));
+        newBuf = (Buffer*)mem;
+
+        unsigned int slots = 1;
+        while (slots < (unsigned int)size)
+        {
+            slots <<= 1;
+        }
 
         newBuf->capacity = size;
+        newBuf->mask = slots - 1;
         newBuf->next_out = 0;
         newBuf->next_in = 0;
-
-        newBuf->buf = (Request**)malloc(sizeof(Request*) * size);
-        for (int ii = 0; ii < size; ii++)
+        newBuf->buf = (Request**)malloc(sizeof(Request*) * slots);
+        if (newBuf->buf == NULL)
         {
-            newBuf->buf[ii] = NULL; // null means slot is empty
+            free(newBuf);
+            newBuf = NULL;
         }
     }
 
@@ -44,18 +59,19 @@ Buffer* createBuffer(int size)
 /* ****************************************************************************
  * NAME:        popBuffer
  * 
- * PURPOSE:     Remove and return the next request in the buffer.
+ * PURPOSE:     Remove and return the next request in the buffer. The slot
+ *              is left as it is; it no longer counts as filled.
  * 
  * IMPORT:      Pointer to the buffer
- * EXPORT:      Pointer to the request
+ * EXPORT:      Pointer to the request (NULL if empty)
  * ***************************************************************************/
 Request* popBuffer(Buffer* buf)
 {
-    Request* req = buf->buf[buf->next_out];
-    if (req != NULL) // Only change pointers if buf wasn't empty
+    Request* req = NULL;
+    if (buf->next_in != buf->next_out) // Only change pointers if not empty
     {
-        buf->buf[buf->next_out] = NULL;
-        buf->next_out = (buf->next_out + 1) % buf->capacity;
+        req = buf->buf[buf->next_out & buf->mask];
+        buf->next_out++;
     }
 
     return req;
@@ -68,14 +84,19 @@ Request* popBuffer(Buffer* buf)
  * 
  * IMPORT:      Pointer to the buffer
  *              Pointer to the request
+ * EXPORT:      Error code (-1 = buffer full, request not added)
  * ***************************************************************************/
-void addToBuffer(Buffer* buf, Request* inReq)
+int addToBuffer(Buffer* buf, Request* inReq)
 {
-    if (buf->buf[buf->next_in] == NULL) // Check for free slot
+    int status = -1;
+    if (!isFull(buf)) // Check for free slot
     {
-        buf->buf[buf->next_in] = inReq;
-        buf->next_in = (buf->next_in + 1) % buf->capacity;
+        buf->buf[buf->next_in & buf->mask] = inReq;
+        buf->next_in++;
+        status = 0;
     }
+
+    return status;
 }
 
 /* ****************************************************************************
@@ -88,13 +109,7 @@ void addToBuffer(Buffer* buf, Request* inReq)
  * ***************************************************************************/
 int isEmpty(Buffer* buf)
 {
-    int empty = 0;
-    if (buf->next_in == buf->next_out && buf->buf[buf->next_in] == NULL)
-    {
-        empty = 1;
-    }
-
-    return empty;
+    return buf->next_in == buf->next_out;
 }
 
 /* ****************************************************************************
@@ -107,13 +122,7 @@ int isEmpty(Buffer* buf)
  * ***************************************************************************/
 int isFull(Buffer* buf)
 {
-    int full = 0;
-    if (buf->next_in == buf->next_out && buf->buf[buf->next_in] != NULL)
-    {
-        full = 1;
-    }
-    
-    return full;
+    return buf->next_in - buf->next_out >= (unsigned int)buf->capacity;
 }
 
 /* ****************************************************************************
@@ -125,12 +134,9 @@ int isFull(Buffer* buf)
  * ***************************************************************************/
 void freeBuffer(Buffer* buf)
 {
-    for(int ii = 0; ii < buf->capacity; ii++)
+    for (unsigned int ii = buf->next_out; ii != buf->next_in; ii++)
     {
-        if (buf->buf[ii] != NULL)
-        {
-            free(buf->buf[ii]);
-        }
+        free(buf->buf[ii & buf->mask]);
     }
 
     free(buf->buf);
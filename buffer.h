@@ -5,21 +5,31 @@
  * 
  * PURPOSE:     Header file for buffer.c
  *
- * LAST MOD:    14/04/20
+ * LAST MOD:    19/10/26
  * ***************************************************************************/
 #include "linked_list.h"
+#include "cache.h"
 
 #ifndef BUFFER
 #define BUFFER
 
+// Largest buffer, so the slots (rounded up to a power of two) stay countable
+#define BUFFER_MAX_SIZE (1 << 30)
+
 // Struct representing the buffer
-// next_in = next_in free slot, next_out = first filled slot.
+// next_in = requests ever added, next_out = requests ever popped. Both only
+// count up (wrapping is harmless), so next_in - next_out is the number
+// waiting and a request's slot is its count masked by the power of two
+// number of slots (mask + 1, at least capacity).
+// next_in is only written by producers and next_out only by consumers, so
+// each sits on its own cache line, away from the read-only fields.
 typedef struct Buffer
 {
     Request** buf;
     int capacity;
-    int next_in;
-    int next_out;
+    unsigned int mask;
+    CACHE_ALIGNED unsigned int next_in;
+    CACHE_ALIGNED unsigned int next_out;
 } Buffer;
 
 #endif
@@ -27,7 +37,7 @@ typedef struct Buffer
 // Prototype Declarations
 Buffer* createBuffer(int size);
 Request* popBuffer(Buffer* buf);
-void addToBuffer(Buffer* buf, Request* inReq);
+int addToBuffer(Buffer* buf, Request* inReq);
 int isEmpty(Buffer* buf);
 int isFull(Buffer* buf);
 void freeBuffer(Buffer* buf);
\ No newline at end of file
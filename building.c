@@ -0,0 +1,329 @@
+/* ****************************************************************************
+ * FILE:        building.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     For creating and managing buildings -- a bundle of a buffer,
+ *              lifts and counters that is simulated independently of every
+ *              other building on the campus.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include "building.h"
+#include "fileio.h"
+#include "linked_list.h"
+#include "priority_buffer.h"
+#include "options.h"
+
+/* ****************************************************************************
+ * NAME:        createBuilding
+ * 
+ * PURPOSE:     To generate a building with an empty buffer and its lifts
+ *              waiting on the ground floor, and its own output file. Its
+ *              threads are left unpinned (core and every lift's cpu are -1)
+ *              unless createBuildings in A places them (--pin).
+ * 
+ * IMPORT:      id - building number (>= 1)
+ *              bufferSize - size of the building's buffer
+ *              numLifts - number of lifts in the building
+ *              liftDelay - milliseconds to delay lift operations
+ *              travel - travel model of the lifts
+ *              dispatch - how lifts pick requests (DISPATCH_xxx)
+ * EXPORT:      pointer to the building struct
+ * ***************************************************************************/
+Building* createBuilding(int id, int bufferSize, int numLifts, int liftDelay,
+                         const TravelModel* travel, int dispatch)
+{
+    Building* building = NULL;
+    void* mem = NULL;
+
+    if (posix_memalign(&mem, CACHE_LINE, sizeof(Building)) != 0)
+    {
+        perror("failed to allocate building");
+        exit(1);
+    }
+    building = (Building*)mem;
+
+    building->id = id;
+    building->core = -1;
+    building->numLifts = numLifts;
+    building->numProducers = 0;
+    building->producers = NULL;
+    building->numRequestsPushed = 0;
+    building->numRequestsServed = 0;
+    building->numReserved = 0;
+    building->pausing = 0;
+    building->numRequestsLogged = 0;
+    building->openProducers = 0;
+    building->closed = 0;
+    building->totalRequests = 0;
+    building->buffer = createPriorityBuffer(bufferSize, 
+                                            dispatch == DISPATCH_NEAREST);
+    if (building->buffer == NULL)
+    {
+        printf("failed to create the buffer of building %d\n", id);
+        exit(1);
+    }
+    building->requests = createLinkedList();
+    building->profiles = createProfiles(numLifts + 1);
+    building->trace = NULL;
+    pthread_mutex_init(&building->bufLock, NULL);
+    pthread_cond_init(&building->bufNotFull, NULL);
+    pthread_cond_init(&building->bufNotEmpty, NULL);
+    pthread_cond_init(&building->allPushed, NULL);
+    pthread_mutex_init(&building->logLock, NULL);
+
+    // Building 1 keeps the original output file name (the file is only
+    // removed once the sim knows it isn't resuming)
+    if (id == 1)
+    {
+        snprintf(building->outFile.name, OUT_NAME_LEN, "%s", OUT_FILE);
+    }
+    else
+    {
+        snprintf(building->outFile.name, OUT_NAME_LEN, OUT_FILE_FMT, id);
+    }
+    building->outFile.log = NULL;
+
+    building->lifts = createLifts(numLifts, liftDelay, travel);
+    building->saved = (LiftState*)malloc(sizeof(LiftState) * numLifts);
+    building->summary = createSummary(numLifts);
+    for (int ii = 0; ii < numLifts; ii++)
+    {
+        building->lifts[ii].building = building;
+        building->lifts[ii].cpu = building->core;
+        building->saved[ii].currFloor = building->lifts[ii].currFloor;
+        building->saved[ii].numRequests = 0;
+        building->saved[ii].numMovements = 0;
+        building->saved[ii].travelMs = 0;
+    }
+
+    return building;
+}
+
+/* ****************************************************************************
+ * NAME:        createLifts
+ * 
+ * PURPOSE:     To generate a cache-aligned array of lifts waiting on the 
+ *              ground floor. Every lift occupies its own cache line, so lift
+ *              threads updating their own lift never contend with each other.
+ *              The array is released with free().
+ * 
+ * IMPORT:      numLifts - number of lifts
+ *              liftDelay - milliseconds to delay lift operations
+ *              travel - travel model (NULL = flat delay only)
+ * EXPORT:      pointer to the first lift
+ * ***************************************************************************/
+Lift* createLifts(int numLifts, int liftDelay, const TravelModel* travel)
+{
+    void* mem = NULL;
+    if (posix_memalign(&mem, CACHE_LINE, sizeof(Lift) * numLifts) != 0)
+    {
+        perror("failed to allocate lifts");
+        exit(1);
+    }
+
+    Lift* lifts = (Lift*)mem;
+    for (int ii = 0; ii < numLifts; ii++)
+    {
+        lifts[ii].id = ii + 1;
+        lifts[ii].currFloor = 1;
+        lifts[ii].delay = liftDelay;
+        lifts[ii].numRequests = 0;
+        lifts[ii].numMovements = 0;
+        lifts[ii].cpu = -1;
+        lifts[ii].travelMs = 0;
+        lifts[ii].building = NULL;
+        lifts[ii].trace = NULL;
+        lifts[ii].travel = travel;
+    }
+
+    return lifts;
+}
+
+/* ****************************************************************************
+ * NAME:        countBuildings
+ * 
+ * PURPOSE:     Returns the highest building id referenced by a list of
+ *              requests, i.e. the number of buildings to create.
+ * 
+ * IMPORT:      requests - list of requests
+ * EXPORT:      Integer number of buildings
+ * ***************************************************************************/
+int countBuildings(LinkedList* requests)
+{
+    int numBuildings = 0;
+    RequestNode* node = requests->head;
+    while (node != NULL)
+    {
+        if (node->req->building > numBuildings)
+        {
+            numBuildings = node->req->building;
+        }
+        node = node->next;
+    }
+
+    return numBuildings;
+}
+
+/* ****************************************************************************
+ * NAME:        routeRequests
+ * 
+ * PURPOSE:     Moves every request from the imported list into the request
+ *              list of the building it belongs to, renumbering the requests
+ *              so each building counts from 1. The imported list is left empty.
+ * 
+ * IMPORT:      requests - list of requests for the whole campus
+ *              buildings - array of buildings (index = id - 1)
+ *              numBuildings - length of the array
+ * ***************************************************************************/
+void routeRequests(LinkedList* requests, Building** buildings, int numBuildings)
+{
+    Request* req = removeStart(requests);
+    while (req != NULL)
+    {
+        Building* building = buildings[req->building - 1];
+
+        building->totalRequests++;
+        req->num = building->totalRequests;
+        insertLast(building->requests, req);
+
+        req = removeStart(requests);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        splitStreams
+ * 
+ * PURPOSE:     Deal the building's requests out to its request threads. 
+ *              Each thread takes the calls of every n-th floor (by start 
+ *              floor), the way a call panel only sees its own floors, and
+ *              they stay in input order within a stream. The building's 
+ *              request list is left empty.
+ * 
+ * IMPORT:      building - the building (requests already routed to it)
+ *              numProducers - number of request threads (>= 1)
+ * ***************************************************************************/
+void splitStreams(Building* building, int numProducers)
+{
+    building->numProducers = numProducers;
+    building->openProducers = numProducers;
+    building->producers = (Producer*)malloc(sizeof(Producer) * numProducers);
+    for (int ii = 0; ii < numProducers; ii++)
+    {
+        building->producers[ii].id = ii + 1;
+        building->producers[ii].building = building;
+        building->producers[ii].stream = createLinkedList();
+    }
+
+    Request* req = removeStart(building->requests);
+    while (req != NULL)
+    {
+        int panel = abs(req->start - GROUND_FLOOR) % numProducers;
+        insertLast(building->producers[panel].stream, req);
+        req = removeStart(building->requests);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        pinThread
+ * 
+ * PURPOSE:     Restrict a thread to run on a single core.
+ * 
+ * IMPORT:      thread - the thread to pin
+ *              core - index of the core
+ * EXPORT:      Error code (non-zero = problem occured)
+ * ***************************************************************************/
+int pinThread(pthread_t thread, int core)
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+
+    return pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpus);
+}
+
+/* ****************************************************************************
+ * NAME:        buildingMovements
+ * 
+ * PURPOSE:     Returns the total number of floors travelled by all lifts in
+ *              the building.
+ * 
+ * IMPORT:      Pointer to the building
+ * EXPORT:      Integer total movements
+ * ***************************************************************************/
+int buildingMovements(Building* building)
+{
+    int total = 0;
+    for (int ii = 0; ii < building->numLifts; ii++)
+    {
+        total += building->lifts[ii].numMovements;
+    }
+
+    return total;
+}
+
+/* ****************************************************************************
+ * NAME:        printBuildingStats
+ * 
+ * PURPOSE:     Print a summary of the building's simulation to the terminal.
+ * 
+ * IMPORT:      Pointer to the building
+ * ***************************************************************************/
+void printBuildingStats(Building* building)
+{
+    char core[16] = "unpinned";
+    if (building->core >= 0)
+    {
+        snprintf(core, sizeof(core), "core %d", building->core);
+    }
+
+    printf("Building %d (%s, %s): %d/%d requests served, %d movements\n",
+            building->id, core, building->outFile.name,
+            building->numRequestsServed, building->totalRequests,
+            buildingMovements(building));
+
+    for (int ii = 0; ii < building->numLifts; ii++)
+    {
+        Lift* lift = &building->lifts[ii];
+        printf("    Lift-%d: %d requests, %d movements, %.3f s travelling, "
+               "at floor %d\n", lift->id, lift->numRequests, 
+               lift->numMovements, lift->travelMs / 1000.0, lift->currFloor);
+    }
+    printClassStats(building->summary);
+}
+
+/* ****************************************************************************
+ * NAME:        freeBuilding
+ * 
+ * PURPOSE:     Free entire building state including its buffer, lifts and
+ *              any requests that were never served.
+ * 
+ * IMPORT:      Pointer to the building
+ * ***************************************************************************/
+void freeBuilding(Building* building)
+{
+    free(building->lifts);
+    free(building->saved);
+    free(building->summary);
+
+    freeLinkedList(building->requests);
+    for (int ii = 0; ii < building->numProducers; ii++)
+    {
+        freeLinkedList(building->producers[ii].stream);
+    }
+    free(building->producers);
+    free(building->profiles);
+    freePriorityBuffer(building->buffer);
+    pthread_mutex_destroy(&building->bufLock);
+    pthread_cond_destroy(&building->bufNotFull);
+    pthread_cond_destroy(&building->bufNotEmpty);
+    pthread_cond_destroy(&building->allPushed);
+    pthread_mutex_destroy(&building->logLock);
+    free(building);
+}
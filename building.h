@@ -0,0 +1,105 @@
+/* ****************************************************************************
+ * FILE:        building.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for building.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <pthread.h>
+#include "lift_sim.h"
+#include "fileio.h"
+#include "linked_list.h"
+#include "priority_buffer.h"
+#include "cache.h"
+#include "profile.h"
+#include "trace.h"
+#include "travel.h"
+#include "summary.h"
+#include "output.h"
+
+#ifndef BUILDING
+#define BUILDING
+
+// A lift as it will be once the request it last took is served, kept by the
+// lift thread under bufLock so it can be checkpointed (see checkpoint.c)
+typedef struct LiftState
+{
+    int currFloor;
+    int numRequests;
+    int numMovements;
+    long long travelMs;
+} LiftState;
+
+// One of a building's request threads (Lift-R), adding the requests of its
+// own stream. With more than one, each takes the calls of every n-th floor,
+// like a call panel (see splitStreams).
+typedef struct Producer
+{
+    int id;
+    struct Building* building;
+    LinkedList* stream;
+} Producer;
+
+// Struct representing one building of the campus.
+// Every building owns its own buffer, lifts, lock and counters, so buildings
+// never share state with each other (shared-nothing).
+// The fields above bufLock are read-only once the sim starts; the lock and
+// everything written under it live on their own cache lines.
+// A request thread reserves a request's slot under bufLock, numbers and 
+// logs it under logLock only, then comes back to add it, so:
+// numReserved = slots reserved (counted against the buffer's capacity) for
+// requests not yet added
+// pausing = a checkpoint is waiting (on allPushed) for numReserved to drain
+// openProducers = request threads still adding; the last one to stop sets
+// closed = no more requests will be added (end of input or SIGINT), so 
+// lifts finding the buffer empty can stop
+// core = CPU of the request threads (-1 = unpinned, unless --pin)
+// logLock is taken by every thread appending to outFile (lifts inside 
+// bufLock, request threads without it); numRequestsLogged = requests 
+// logged, which also numbers them, so numbering stays global to the 
+// building and follows the log
+typedef struct Building
+{
+    int id;
+    int core;
+    int numLifts;
+    int numProducers;
+    int totalRequests;
+    OutFile outFile;
+    PriorityBuffer* buffer;
+    Lift* lifts;
+    Producer* producers;
+    LiftState* saved;
+    Summary* summary;
+    LinkedList* requests;
+    Profile* profiles;
+    Trace* trace;
+    CACHE_ALIGNED pthread_mutex_t bufLock;
+    pthread_cond_t bufNotFull;
+    pthread_cond_t bufNotEmpty;
+    pthread_cond_t allPushed;
+    int numRequestsPushed;
+    int numRequestsServed;
+    int numReserved;
+    int pausing;
+    int openProducers;
+    int closed;
+    CACHE_ALIGNED pthread_mutex_t logLock;
+    int numRequestsLogged;
+} CACHE_ALIGNED Building;
+
+#endif
+
+// Prototype Declarations
+Building* createBuilding(int id, int bufferSize, int numLifts, int liftDelay,
+                         const TravelModel* travel, int dispatch);
+int countBuildings(LinkedList* requests);
+void routeRequests(LinkedList* requests, Building** buildings, int numBuildings);
+void splitStreams(Building* building, int numProducers);
+int pinThread(pthread_t thread, int core);
+int buildingMovements(Building* building);
+void printBuildingStats(Building* building);
+void freeBuilding(Building* building);
+Lift* createLifts(int numLifts, int liftDelay, const TravelModel* travel);
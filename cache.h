@@ -0,0 +1,22 @@
+/* ****************************************************************************
+ * FILE:        cache.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Cache line size and alignment helpers, used to keep state that
+ *              is written by different threads on different cache lines
+ *              (avoiding false sharing).
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+
+#ifndef CACHE
+#define CACHE
+
+// Size of a cache line in bytes (x86-64 and most ARM cores)
+#define CACHE_LINE 64
+
+// Align a struct or member to the start of a cache line
+#define CACHE_ALIGNED __attribute__((aligned(CACHE_LINE)))
+
+#endif
@@ -0,0 +1,416 @@
+/* ****************************************************************************
+ * FILE:        checkpoint.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Checkpoints a running simulation to a binary file, and sets
+ *              the buildings back up from one so a long sim can carry on
+ *              after a crash instead of starting from request 1.
+ *
+ *              Each building is copied under its bufLock, once every
+ *              request already numbered has been logged and added (no more
+ *              are numbered meanwhile), so its buffer, counters and output
+ *              file always agree. Lifts can be mid-move at the time, so
+ *              they are saved as they will be once their current request
+ *              is served (the log already says so). The file is written
+ *              beside the old one and renamed over it, so a crash while
+ *              checkpointing never loses the last checkpoint.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "checkpoint.h"
+#include "output.h"
+#include "travel.h"
+
+static void* takeCheckpoints(void* arg);
+static int saveBuilding(FILE* file, Building* building);
+static int loadBuilding(FILE* file, Building* building);
+
+/* ****************************************************************************
+ * NAME:        startCheckpoints
+ *
+ * PURPOSE:     Start the thread checkpointing the sim every CHECKPOINT_MS.
+ *
+ * IMPORT:      path - checkpoint file
+ *              buildings - array of buildings to checkpoint
+ *              numBuildings - length of the array
+ * EXPORT:      pointer to the checkpointer
+ * ***************************************************************************/
+Checkpointer* startCheckpoints(const char* path, Building** buildings,
+                               int numBuildings)
+{
+    Checkpointer* cp = (Checkpointer*)malloc(sizeof(Checkpointer));
+    snprintf(cp->path, sizeof(cp->path), "%s", path);
+    cp->stop = 0;
+    cp->buildings = buildings;
+    cp->numBuildings = numBuildings;
+    pthread_create(&cp->thread, NULL, takeCheckpoints, cp);
+
+    return cp;
+}
+
+/* ****************************************************************************
+ * NAME:        stopCheckpoints
+ *
+ * PURPOSE:     Stop the checkpointing thread, take one last checkpoint (of
+ *              the finished sim) and free the checkpointer.
+ *
+ * IMPORT:      Pointer to the checkpointer (may be NULL)
+ * ***************************************************************************/
+void stopCheckpoints(Checkpointer* cp)
+{
+    if (cp != NULL)
+    {
+        __atomic_store_n(&cp->stop, 1, __ATOMIC_RELAXED);
+        pthread_join(cp->thread, NULL);
+
+        writeCheckpoint(cp->path, cp->buildings, cp->numBuildings);
+        free(cp);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        writeCheckpoint
+ *
+ * PURPOSE:     Checkpoint every building to a file.
+ *
+ * IMPORT:      path - checkpoint file
+ *              buildings - array of buildings (at least one)
+ *              numBuildings - length of the array
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int writeCheckpoint(const char* path, Building** buildings, int numBuildings)
+{
+    int status = 0;
+    char tmp[CHECKPOINT_NAME_LEN + 8];
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE* file = fopen(tmp, "wb");
+    if (file == NULL)
+    {
+        perror("there was an error opening the checkpoint");
+        status = -1;
+    }
+    else
+    {
+        CheckpointHeader header;
+        memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+        header.version = CHECKPOINT_VERSION;
+        header.numBuildings = numBuildings;
+        header.numLifts = buildings[0]->numLifts;
+        header.bufferSize = buildings[0]->buffer->capacity;
+        fwrite(&header, sizeof(header), 1, file);
+
+        for (int ii = 0; ii < numBuildings; ii++)
+        {
+            status |= saveBuilding(file, buildings[ii]);
+        }
+
+        // Make sure it is on disk before it replaces the last one
+        if (status == -1 || fflush(file) != 0 || fsync(fileno(file)) == -1 ||
+            ferror(file))
+        {
+            perror("there was an error writing the checkpoint");
+            status = -1;
+        }
+        fclose(file);
+
+        if (status == 0 && rename(tmp, path) == -1)
+        {
+            perror("there was an error writing the checkpoint");
+            status = -1;
+        }
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        resumeCheckpoint
+ *
+ * PURPOSE:     Set freshly created buildings (with their requests routed)
+ *              back to how they were at a checkpoint: requests already taken
+ *              from the input are dropped, buffers refilled, lifts and
+ *              counters restored, and output files cut back to what they
+ *              held at the time.
+ *
+ * IMPORT:      path - checkpoint file
+ *              buildings - array of buildings
+ *              numBuildings - length of the array
+ * EXPORT:      Error code (-1 = no usable checkpoint for this sim)
+ * ***************************************************************************/
+int resumeCheckpoint(const char* path, Building** buildings, int numBuildings)
+{
+    int status = 0;
+    CheckpointHeader header;
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        perror("there was an error opening the checkpoint");
+        status = -1;
+    }
+    else
+    {
+        if (fread(&header, sizeof(header), 1, file) != 1 ||
+            memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) ||
+            header.version != CHECKPOINT_VERSION)
+        {
+            printf("%s is not a checkpoint\n", path);
+            status = -1;
+        }
+        else if (header.numBuildings != numBuildings ||
+                 header.numLifts != buildings[0]->numLifts ||
+                 header.bufferSize != buildings[0]->buffer->capacity)
+        {
+            printf("checkpoint %s was taken with %d buildings, %d lifts and "
+                   "a buffer of %d\n", path, header.numBuildings,
+                   header.numLifts, header.bufferSize);
+            status = -1;
+        }
+
+        for (int ii = 0; ii < numBuildings && status == 0; ii++)
+        {
+            status = loadBuilding(file, buildings[ii]);
+        }
+        fclose(file);
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        saveLiftState
+ *
+ * PURPOSE:     Work out how a lift will be once it has served a request.
+ *              Called by the lift thread under bufLock, as it takes the
+ *              request.
+ *
+ * IMPORT:      state - where to save the lift
+ *              lift - the lift, before it moves
+ *              req - the request it is about to serve
+ * ***************************************************************************/
+void saveLiftState(LiftState* state, const Lift* lift, const Request* req)
+{
+    int toStart = abs(lift->currFloor - req->start);
+    int toDest = abs(req->start - req->destination);
+
+    state->currFloor = req->destination;
+    state->numRequests = lift->numRequests;
+    state->numMovements = lift->numMovements + toStart + toDest;
+    state->travelMs = lift->travelMs +
+                      legTimeMs(lift->travel, lift->delay, toDest);
+    if (toStart != 0)
+    {
+        state->travelMs += legTimeMs(lift->travel, lift->delay, toStart);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        takeCheckpoints
+ *
+ * PURPOSE:     Thread body: checkpoint every CHECKPOINT_MS until told to
+ *              stop.
+ *
+ * IMPORT:      Pointer to the checkpointer
+ * ***************************************************************************/
+static void* takeCheckpoints(void* arg)
+{
+    Checkpointer* cp = (Checkpointer*)arg;
+    int sinceLast = 0;
+
+    // Wake up regularly to notice stop requests
+    while (__atomic_load_n(&cp->stop, __ATOMIC_RELAXED) == 0)
+    {
+        sleepMs(100);
+        sinceLast += 100;
+        if (sinceLast >= CHECKPOINT_MS)
+        {
+            writeCheckpoint(cp->path, cp->buildings, cp->numBuildings);
+            sinceLast = 0;
+        }
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        saveBuilding
+ *
+ * PURPOSE:     Copy a building under its lock, then append it to the file.
+ *
+ * IMPORT:      file - checkpoint file
+ *              building - the building
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+static int saveBuilding(FILE* file, Building* building)
+{
+    int status = 0;
+    BuildingState state;
+    struct stat out;
+
+    Request* queued = (Request*)malloc(sizeof(Request) * 
+                                       building->buffer->capacity);
+    LiftState* lifts = (LiftState*)malloc(sizeof(LiftState) *
+                                          building->numLifts);
+    size_t sumBytes = summaryBytes(building->numLifts);
+    Summary* summary = (Summary*)malloc(sumBytes);
+
+    pthread_mutex_lock(&building->bufLock); // CRITICAL SECTION START
+    building->pausing = 1;
+    while (building->numReserved > 0)
+    {
+        pthread_cond_wait(&building->allPushed, &building->bufLock);
+    }
+
+    state.id = building->id;
+    state.totalRequests = building->totalRequests;
+    state.numRequestsPushed = building->numRequestsPushed;
+    state.numRequestsServed = building->numRequestsServed;
+    state.outOffset = 0;
+    pthread_mutex_lock(&building->logLock);
+    simOutput->flush(&building->outFile); // nothing may still be batched
+    pthread_mutex_unlock(&building->logLock);
+    if (stat(building->outFile.name, &out) == 0)
+    {
+        state.outOffset = out.st_size;
+    }
+
+    // Everything pushed but not yet taken is in the buffer
+    int numQueued = copyPriorityBuffer(building->buffer, queued);
+    long long now = profileNow();
+    memcpy(lifts, building->saved, sizeof(LiftState) * building->numLifts);
+    memcpy(summary, building->summary, sumBytes);
+    building->pausing = 0;
+    pthread_cond_broadcast(&building->bufNotFull);
+    pthread_mutex_unlock(&building->bufLock); // CRITICAL SECTION END
+
+    // The clock a request was queued by means nothing after a restart (or 
+    // on another machine), so save how long it has waited
+    for (int ii = 0; ii < numQueued; ii++)
+    {
+        queued[ii].queuedNs = now - queued[ii].queuedNs;
+    }
+
+    if (fwrite(&state, sizeof(state), 1, file) != 1 ||
+        fwrite(queued, sizeof(Request), numQueued, file) != numQueued ||
+        fwrite(lifts, sizeof(LiftState), building->numLifts, file) !=
+            building->numLifts ||
+        fwrite(summary, sumBytes, 1, file) != 1)
+    {
+        status = -1;
+    }
+
+    free(queued);
+    free(lifts);
+    free(summary);
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        loadBuilding
+ *
+ * PURPOSE:     Read the next building from the file and restore it.
+ *
+ * IMPORT:      file - checkpoint file, positioned at the building
+ *              building - the building to restore
+ * EXPORT:      Error code (-1 = the building doesn't match)
+ * ***************************************************************************/
+static int loadBuilding(FILE* file, Building* building)
+{
+    int status = 0;
+    BuildingState state;
+    long long now = profileNow();
+
+    if (fread(&state, sizeof(state), 1, file) != 1 ||
+        state.id != building->id ||
+        state.totalRequests != building->totalRequests ||
+        state.numRequestsServed > state.numRequestsPushed ||
+        state.numRequestsPushed > state.totalRequests ||
+        state.numRequestsPushed - state.numRequestsServed >
+            building->buffer->capacity)
+    {
+        printf("checkpoint doesn't match building %d of this input\n",
+               building->id);
+        status = -1;
+    }
+    else
+    {
+        // Skip what was already taken from the input
+        for (int ii = 0; ii < state.numRequestsPushed; ii++)
+        {
+            free(removeStart(building->requests));
+        }
+
+        for (int ii = 0; ii < state.numRequestsPushed -
+                              state.numRequestsServed && status == 0; ii++)
+        {
+            Request* req = (Request*)malloc(sizeof(Request));
+            if (fread(req, sizeof(Request), 1, file) != 1)
+            {
+                free(req);
+                status = -1;
+            }
+            else
+            {
+                // Saved as its wait so far, carry it on from now
+                if (req->queuedNs < 0)
+                {
+                    req->queuedNs = 0;
+                }
+                req->queuedNs = now - req->queuedNs;
+                addToPriorityBuffer(building->buffer, req);
+            }
+        }
+
+        if (status == 0 && fread(building->saved, sizeof(LiftState),
+                                 building->numLifts, file) !=
+                                 building->numLifts)
+        {
+            status = -1;
+        }
+
+        if (status == 0 && fread(building->summary, 
+                                 summaryBytes(building->numLifts), 1, 
+                                 file) != 1)
+        {
+            status = -1;
+        }
+
+        if (status == -1)
+        {
+            printf("checkpoint of building %d is cut short\n", building->id);
+        }
+        else
+        {
+            for (int ii = 0; ii < building->numLifts; ii++)
+            {
+                Lift* lift = &building->lifts[ii];
+                lift->currFloor = building->saved[ii].currFloor;
+                lift->numRequests = building->saved[ii].numRequests;
+                lift->numMovements = building->saved[ii].numMovements;
+                lift->travelMs = building->saved[ii].travelMs;
+            }
+            building->numRequestsPushed = state.numRequestsPushed;
+            building->numRequestsServed = state.numRequestsServed;
+            building->numRequestsLogged = state.numRequestsPushed;
+
+            // Anything logged after the checkpoint will be logged again
+            if (truncate(building->outFile.name, state.outOffset) == -1 &&
+                state.outOffset > 0)
+            {
+                perror("there was an error cutting back the output file");
+                status = -1;
+            }
+        }
+    }
+
+    return status;
+}
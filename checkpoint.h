@@ -0,0 +1,63 @@
+/* ****************************************************************************
+ * FILE:        checkpoint.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Header file for checkpoint.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <pthread.h>
+#include "building.h"
+
+#ifndef CHECKPOINT
+#define CHECKPOINT
+
+#define CHECKPOINT_MAGIC "LIFTCKPT"
+#define CHECKPOINT_VERSION 4
+#define CHECKPOINT_MS 500 // how often a checkpoint is taken
+#define CHECKPOINT_NAME_LEN 256
+
+// A checkpoint file is this header, followed by every building as:
+// BuildingState, the requests in its buffer (class by class, oldest first
+// within a class, queuedNs holding how long each had waited), a LiftState 
+// for each lift, then its summary (summaryBytes long).
+typedef struct CheckpointHeader
+{
+    char magic[8];
+    int version;
+    int numBuildings;
+    int numLifts;
+    int bufferSize;
+} CheckpointHeader;
+
+// pushed = requests taken from the input (the rest are re-read on resume)
+// outOffset = length of the building's output file
+typedef struct BuildingState
+{
+    int id;
+    int totalRequests;
+    int numRequestsPushed;
+    int numRequestsServed;
+    long long outOffset;
+} BuildingState;
+
+// The thread taking checkpoints
+typedef struct Checkpointer
+{
+    char path[CHECKPOINT_NAME_LEN];
+    int stop;
+    Building** buildings;
+    int numBuildings;
+    pthread_t thread;
+} Checkpointer;
+
+#endif
+
+// Prototype Declarations
+Checkpointer* startCheckpoints(const char* path, Building** buildings,
+                               int numBuildings);
+void stopCheckpoints(Checkpointer* cp);
+int writeCheckpoint(const char* path, Building** buildings, int numBuildings);
+int resumeCheckpoint(const char* path, Building** buildings, int numBuildings);
+void saveLiftState(LiftState* state, const Lift* lift, const Request* req);
@@ -8,20 +8,71 @@
  *                  - writing requests, and 
  *                  - writing lift operations
  *
- * LAST MOD:    12/04/20 
+ * LAST MOD:    19/10/26 
  * ***************************************************************************/
+#define _POSIX_C_SOURCE 200112L
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "fileio.h"
 #include "lift_sim.h"
 #include "linked_list.h"
+#include "render.h"
+
+#define PARSE_OK 0
+#define PARSE_NOT_POSITIVE 1
+#define PARSE_BAD_FLOOR 2
+#define PARSE_BAD_BUILDING 3
+#define PARSE_BAD_PRIORITY 4
+#define PARSE_MISSING 5
+
+// An invalid line, line = line number within its chunk (from 1)
+typedef struct ParseError
+{
+    int line;
+    int kind;
+} ParseError;
+
+// One thread's share of the input file
+// firstLine / firstNum = lines / requests in every chunk before this one
+// raw = keep any line with two floors, whatever their values (see readTrace)
+typedef struct ParseChunk
+{
+    const char* begin;
+    const char* end;
+    int min;
+    int max;
+    int raw;
+    int numLines;
+    int firstLine;
+    int firstNum;
+    LinkedList* requests;
+    ParseError* errors;
+    int numErrors;
+    struct ParseChunk* chunks;
+    int numChunks;
+    pthread_barrier_t* barrier;
+} ParseChunk;
+
+static void* parseChunk(void* arg);
+static int pickChunks(long size);
+static int parseFile(char* filename, LinkedList* reqList, const int min, 
+                     const int max, int numChunks, int raw);
 
 /* ****************************************************************************
  * NAME:        readRequests
  * 
  * PURPOSE:     Constructs a number of Lift Requests from an input file and
- *              appends them an imported list.
+ *              appends them an imported list. Each line is of the form
+ *              "[start] [destination] <optional building id> <optional 
+ *              priority>", where a missing building id means the request is
+ *              for building 1 and a missing priority means class 0.
+ *
+ *              Large files are split into newline-aligned chunks parsed by
+ *              one thread each (see parseChunk). Requests are numbered, and
+ *              invalid lines reported, exactly as a single pass would.
  * 
  * IMPORT:      filename - name of fiel
  *              reqList - list to house requests
@@ -31,13 +82,68 @@
  * ***************************************************************************/
 int readRequests(char *filename, LinkedList* reqList, const int min, const int max)
 {
-    char startStr[BUF], destStr[BUF];
-    int numRequests = 0, linenum = 0, status = 0;
+    return readRequestsChunked(filename, reqList, min, max, 0);
+}
 
-    // Remove old output file
-    remove("sim_out.csv");
+/* ****************************************************************************
+ * NAME:        readRequestsChunked
+ * 
+ * PURPOSE:     readRequests with the number of chunks given, so the tests 
+ *              can split even a small file many ways. 0 picks the count 
+ *              from the file size and the cores (see pickChunks).
+ * 
+ * IMPORT:      filename - name of file
+ *              reqList - list to house requests
+ *              min - min floor
+ *              max - max floor
+ *              numChunks - chunks to parse in parallel (0 = automatic)
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int readRequestsChunked(char *filename, LinkedList* reqList, const int min, 
+                        const int max, int numChunks)
+{
+    return parseFile(filename, reqList, min, max, numChunks, FALSE);
+}
 
-    // Open and check file
+/* ****************************************************************************
+ * NAME:        readTrace
+ * 
+ * PURPOSE:     Reads a file like readRequests, but keeps every line with a 
+ *              start and destination as a request, whatever its floors, 
+ *              building and priority (zero and negative floors too). Only
+ *              lines missing a floor are reported. For --analyze, which 
+ *              counts the out of range requests itself.
+ * 
+ * IMPORT:      filename - name of file
+ *              reqList - list to house requests
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int readTrace(char* filename, LinkedList* reqList)
+{
+    return parseFile(filename, reqList, 0, 0, 0, TRUE);
+}
+
+/* ****************************************************************************
+ * NAME:        parseFile
+ * 
+ * PURPOSE:     Read the file in and parse it, one thread per chunk, for 
+ *              readRequestsChunked and readTrace.
+ * 
+ * IMPORT:      filename - name of file
+ *              reqList - list to house requests
+ *              min, max - floors allowed (unless raw)
+ *              numChunks - chunks to parse in parallel (0 = automatic)
+ *              raw - TRUE to keep out of range requests
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+static int parseFile(char* filename, LinkedList* reqList, const int min, 
+                     const int max, int numChunks, int raw)
+{
+    int status = 0;
+    char* text = NULL;
+    long size = 0;
+
+    // Open and check file, then read it in whole
     FILE* file = fopen(filename, "r");
     if (file == NULL)
     {
@@ -46,89 +152,303 @@ int readRequests(char *filename, LinkedList* reqList, const int min, const int m
     }
     else
     {
-        // Begin looping through requests.
-        // If request is valid, add to request list
-        while (fscanf(file, "%s %s%*[^\n]\n", startStr, destStr) != EOF)
-        { 
-            linenum++;
-
-            int start = atoi(startStr);
-            int dest = atoi(destStr);
-
-            if ((start == 0) || (dest == 0))
+        if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) >= 0 &&
+            fseek(file, 0, SEEK_SET) == 0)
+        {
+            text = (char*)malloc(size + 1);
+            if (fread(text, 1, size, file) != (size_t)size)
             {
-                printf("error in %s at line %d: ", filename, linenum);
-                printf("floor must be a positive numeric value\n");
+                size = -1;
             }
-            else if ((start < min) || (start > max) ||
-                     (dest < min) || (dest > max))
+        }
+        else
+        {
+            size = -1;
+        }
+
+        // Final error check
+        if (size == -1 || ferror(file))
+        {
+            perror("there was an error reading the file");
+            status = -1;
+        }
+        fclose(file);
+    }
+
+    if (status == 0)
+    {
+        if (numChunks <= 0)
+        {
+            numChunks = pickChunks(size);
+        }
+        if (numChunks > MAX_PARSE_THREADS)
+        {
+            numChunks = MAX_PARSE_THREADS;
+        }
+
+        ParseChunk* chunks = (ParseChunk*)malloc(sizeof(ParseChunk) * 
+                                                 numChunks);
+        pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * numChunks);
+        pthread_barrier_t barrier;
+        pthread_barrier_init(&barrier, NULL, numChunks);
+
+        // Every chunk starts just after a newline
+        const char* begin = text;
+        for (int ii = 0; ii < numChunks; ii++)
+        {
+            const char* end = text + size * (ii + 1) / numChunks;
+            while (end < text + size && end > text && end[-1] != '\n')
             {
-                printf("error in %s at line %d: ", filename, linenum);
-                printf("only %d to %d floors\n", min, max);
+                end++;
             }
-            else // the request is valid
+            if (end < begin)
             {
-                numRequests++;
-                Request* req = (Request*)malloc(sizeof(Request));
-                req->num = numRequests;
-                req->start = start;
-                req->destination = dest;
-                insertLast(reqList, req);
+                end = begin;
             }
+
+            chunks[ii].begin = begin;
+            chunks[ii].end = end;
+            chunks[ii].min = min;
+            chunks[ii].max = max;
+            chunks[ii].raw = raw;
+            chunks[ii].requests = createLinkedList();
+            chunks[ii].errors = NULL;
+            chunks[ii].numErrors = 0;
+            chunks[ii].chunks = chunks;
+            chunks[ii].numChunks = numChunks;
+            chunks[ii].barrier = (numChunks > 1) ? &barrier : NULL;
+            begin = end;
         }
 
-        // Final error check
-        if (ferror(file))
+        for (int ii = 1; ii < numChunks; ii++)
         {
-            perror("there was an error closing the file");
-            status = -1;
+            pthread_create(&threads[ii], NULL, parseChunk, &chunks[ii]);
         }
-        fclose(file);
+        parseChunk(&chunks[0]);
+        for (int ii = 1; ii < numChunks; ii++)
+        {
+            pthread_join(threads[ii], NULL);
+        }
+
+        // Report invalid lines and gather the requests, in file order
+        for (int ii = 0; ii < numChunks; ii++)
+        {
+            for (int jj = 0; jj < chunks[ii].numErrors; jj++)
+            {
+                ParseError* err = &chunks[ii].errors[jj];
+                printf("error in %s at line %d: ", filename, 
+                       chunks[ii].firstLine + err->line);
+
+                if (err->kind == PARSE_NOT_POSITIVE)
+                {
+                    printf("floor must be a positive numeric value\n");
+                }
+                else if (err->kind == PARSE_BAD_FLOOR)
+                {
+                    printf("only %d to %d floors\n", min, max);
+                }
+                else if (err->kind == PARSE_BAD_BUILDING)
+                {
+                    printf("only buildings 1 to %d\n", MAX_BUILDINGS);
+                }
+                else if (err->kind == PARSE_MISSING)
+                {
+                    printf("needs a start and a destination floor\n");
+                }
+                else
+                {
+                    printf("only priority classes 0 to %d\n", 
+                           NUM_PRIORITIES - 1);
+                }
+            }
+
+            appendList(reqList, chunks[ii].requests);
+            free(chunks[ii].requests);
+            free(chunks[ii].errors);
+        }
+
+        pthread_barrier_destroy(&barrier);
+        free(threads);
+        free(chunks);
     }
 
+    free(text);
+
     return status;
 }
 
 /* ****************************************************************************
- * NAME:        writeRequest
+ * NAME:        pickChunks
  * 
- * PURPOSE:     Append a request struct to the output file.
+ * PURPOSE:     One chunk per core, unless chunks would be too small to be 
+ *              worth a thread.
  * 
- * IMPORT:      Pointer to a request
- * EXPORT:      Error code (-1 = problem occured)
+ * IMPORT:      size - bytes in the file
+ * EXPORT:      Number of chunks
  * ***************************************************************************/
-int writeRequest(Request* req)
+static int pickChunks(long size)
 {
-    int status = 0; 
-
-    // Open and check file
-    FILE* file = fopen(OUT_FILE, "a");
-    if (file == NULL)
+    long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+    int numChunks = (int)(size / PARSE_CHUNK_MIN) + 1;
+    if (numChunks > numCores)
     {
-        perror("there was an error opening the file");
-        status = -1;
+        numChunks = numCores > 0 ? (int)numCores : 1;
     }
-    else
+
+    return numChunks;
+}
+
+/* ****************************************************************************
+ * NAME:        parseChunk
+ * 
+ * PURPOSE:     Thread body: parse the lines of one chunk into its own list, 
+ *              numbering requests from 1 and noting invalid lines. Once 
+ *              every chunk is parsed, one thread sums up the lines and 
+ *              requests before each chunk, and every thread renumbers its 
+ *              requests to follow on from the chunks before it.
+ * 
+ * IMPORT:      Pointer to the chunk
+ * ***************************************************************************/
+static void* parseChunk(void* arg)
+{
+    ParseChunk* chunk = (ParseChunk*)arg;
+    char line[LINE_BUF], startStr[BUF], destStr[BUF], buildingStr[BUF];
+    char priorityStr[BUF];
+    int maxErrors = 0;
+    const char* pos = chunk->begin;
+
+    chunk->numLines = 0;
+    while (pos < chunk->end)
     {
-        // Do writing
-        fprintf(file, "------------------------------------------\n");
-        fprintf(file, "New Lift Request From Floor %d to Floor %d\n",
-                req->start, req->destination);
+        const char* eol = memchr(pos, '\n', chunk->end - pos);
+        if (eol == NULL)
+        {
+            eol = chunk->end; // last line without a newline
+        }
 
-        fprintf(file, "Request No: %d\n", req->num);
-        fprintf(file, "------------------------------------------\n");
-        fprintf(file, "\n"); // Done
+        int len = (int)(eol - pos);
+        if (len > LINE_BUF - 1)
+        {
+            len = LINE_BUF - 1;
+        }
+        memcpy(line, pos, len);
+        line[len] = '\0';
+        pos = eol + 1;
+        chunk->numLines++;
 
-        // Final error check
-        if (ferror(file))
+        int numFields = sscanf(line, "%9s %9s %9s %9s", startStr, destStr, 
+                               buildingStr, priorityStr);
+        if (numFields < 1)
         {
-            perror("there was an error closing the file");
-            status = -1;
+            continue; // blank line
+        }
+
+        int start = atoi(startStr);
+        int dest = (numFields >= 2) ? atoi(destStr) : 0;
+        int building = (numFields >= 3) ? atoi(buildingStr) 
+                                        : DEFAULT_BUILDING;
+        int priority = (numFields >= 4) ? atoi(priorityStr) : 0;
+        int kind = PARSE_OK;
+
+        if (chunk->raw)
+        {
+            if (numFields < 2)
+            {
+                kind = PARSE_MISSING;
+            }
+        }
+        else if ((start == 0) || (dest == 0))
+        {
+            kind = PARSE_NOT_POSITIVE;
+        }
+        else if ((start < chunk->min) || (start > chunk->max) ||
+                 (dest < chunk->min) || (dest > chunk->max))
+        {
+            kind = PARSE_BAD_FLOOR;
+        }
+        else if ((building < 1) || (building > MAX_BUILDINGS))
+        {
+            kind = PARSE_BAD_BUILDING;
+        }
+        else if ((priority < 0) || (priority >= NUM_PRIORITIES))
+        {
+            kind = PARSE_BAD_PRIORITY;
+        }
+
+        if (kind != PARSE_OK)
+        {
+            if (chunk->numErrors == maxErrors)
+            {
+                maxErrors = maxErrors * 2 + 8;
+                chunk->errors = (ParseError*)realloc(chunk->errors, 
+                                    sizeof(ParseError) * maxErrors);
+            }
+            chunk->errors[chunk->numErrors].line = chunk->numLines;
+            chunk->errors[chunk->numErrors].kind = kind;
+            chunk->numErrors++;
+        }
+        else // the request is valid
+        {
+            Request* req = (Request*)malloc(sizeof(Request));
+            req->num = chunk->requests->size + 1;
+            req->start = start;
+            req->destination = dest;
+            req->building = building;
+            req->priority = priority;
+            req->queuedNs = 0;
+            insertLast(chunk->requests, req);
         }
-        fclose(file);
     }
 
-    return status;
+    // Prefix sums over the chunks, worked out by whichever thread is last
+    int serial = PTHREAD_BARRIER_SERIAL_THREAD;
+    if (chunk->barrier != NULL)
+    {
+        serial = pthread_barrier_wait(chunk->barrier);
+    }
+    if (serial == PTHREAD_BARRIER_SERIAL_THREAD)
+    {
+        int lines = 0, requests = 0;
+        for (int ii = 0; ii < chunk->numChunks; ii++)
+        {
+            chunk->chunks[ii].firstLine = lines;
+            chunk->chunks[ii].firstNum = requests;
+            lines += chunk->chunks[ii].numLines;
+            requests += chunk->chunks[ii].requests->size;
+        }
+    }
+    if (chunk->barrier != NULL)
+    {
+        pthread_barrier_wait(chunk->barrier);
+    }
+
+    if (chunk->firstNum > 0)
+    {
+        for (RequestNode* node = chunk->requests->head; node != NULL; 
+             node = node->next)
+        {
+            node->req->num += chunk->firstNum;
+        }
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        writeRequest
+ * 
+ * PURPOSE:     Append a request struct to the output file.
+ * 
+ * IMPORT:      Pointer to a request
+ *              Name of the output file
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int writeRequest(Request* req, char* outFile)
+{
+    char text[EVENT_LEN];
+    renderRequest(text, req);
+
+    return appendText(text, outFile);
 }
 
 /* ****************************************************************************
@@ -138,14 +458,32 @@ int writeRequest(Request* req)
  * 
  * IMPORT:      Pointer to the lift struct
  *              Pointer to the request
+ *              Name of the output file
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int writeLiftActivity(Lift* lift, Request* req, char* outFile)
+{
+    char text[EVENT_LEN];
+    renderLiftActivity(text, lift, req);
+
+    return appendText(text, outFile);
+}
+
+/* ****************************************************************************
+ * NAME:        appendText
+ * 
+ * PURPOSE:     Append an entry to the output file.
+ * 
+ * IMPORT:      text - the entry
+ *              Name of the output file
  * EXPORT:      Error code (-1 = problem occured)
  * ***************************************************************************/
-int writeLiftActivity(Lift* lift, Request* req)
+int appendText(const char* text, char* outFile)
 {
     int status = 0; 
 
     // Open and check file
-    FILE* file = fopen(OUT_FILE, "a");
+    FILE* file = fopen(outFile, "a");
     if (file == NULL)
     {
         perror("there was an error opening the file");
@@ -153,28 +491,7 @@ int writeLiftActivity(Lift* lift, Request* req)
     }
     else
     {
-        // Do writing
-        fprintf(file, "Lift-%d Operation\n", lift->id);
-        fprintf(file, "Previous position: Floor %d\n", lift->currFloor);
-        fprintf(file, "Request: Floor %d to %d\n", req->start, req->destination);
-        fprintf(file, "Detail operations:\n");
-
-        if (lift->currFloor != req->start)
-        {
-            fprintf(file, "    Go from Floor %d to Floor %d\n",
-                    lift->currFloor, req->start);
-        }
-        
-        fprintf(file, "    Go from Floor %d to Floor %d\n",
-                req->start, req->destination);
-
-        int numMov = (abs(lift->currFloor - req->start)) + 
-                     (abs(req->start - req->destination));
-        fprintf(file, "    #movements for this request: %d\n", numMov);
-        fprintf(file, "    #request: %d\n", lift->numRequests);
-        fprintf(file, "    Total #movement: %d\n", lift->numMovements + numMov);
-        fprintf(file, "Current position: Floor %d\n", req->destination);
-        fprintf(file, "\n"); // Done
+        fputs(text, file);
 
         // Final error check
         if (ferror(file))
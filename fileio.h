@@ -5,7 +5,7 @@
  *
  * PURPOSE:     Header file for fileio.c
  *
- * LAST MOD:    12/04/20 
+ * LAST MOD:    19/10/26 
  * ***************************************************************************/
 #include "linked_list.h"
 #include "lift_sim.h"
@@ -13,10 +13,21 @@
 // Constants
 #define FALSE 0
 #define TRUE !FALSE
-#define BUF 10 // Assumption: no line will be more than 20 chars long 
+#define BUF 10 // Assumption: no line will be more than 30 chars long 
+#define LINE_BUF 64
 #define OUT_FILE "sim_out.csv"
+#define OUT_FILE_FMT "sim_out_%d.csv" // for buildings other than the first
+#define OUT_NAME_LEN 32
+
+// Parallel parsing of the input file (see readRequests)
+#define PARSE_CHUNK_MIN (1 << 16) // bytes, smaller files use one thread
+#define MAX_PARSE_THREADS 64
 
 // Prototype Declarations
 int readRequests(char* filename, LinkedList* reqList, const int min, const int max);
-int writeRequest(Request* req);
-int writeLiftActivity(Lift* lift, Request* req);
\ No newline at end of file
+int readRequestsChunked(char* filename, LinkedList* reqList, const int min, 
+                        const int max, int numChunks);
+int readTrace(char* filename, LinkedList* reqList);
+int writeRequest(Request* req, char* outFile);
+int writeLiftActivity(Lift* lift, Request* req, char* outFile);
+int appendText(const char* text, char* outFile);
\ No newline at end of file
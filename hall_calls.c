@@ -0,0 +1,309 @@
+/* ****************************************************************************
+ * FILE:        hall_calls.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     An index of waiting requests by floor and direction, kept
+ *              alongside the buffer (see priority_buffer.c), so a dispatcher
+ *              can find the nearest call in a lift's direction of travel.
+ *              A bitmap per direction marks the floors with calls waiting,
+ *              and the nearest one is found a word (64 floors) at a time
+ *              with a bit-scan, however many requests are waiting. Each
+ *              floor keeps its calls in order in a small ring, so taking
+ *              the oldest (as the buffer pops them, unless a more urgent
+ *              class jumps the queue) is O(1).
+ *
+ *              Nothing is locked here: the index is used under the same
+ *              lock as its buffer.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "hall_calls.h"
+
+static void setWaiting(HallCalls* calls, int floor, int dir, int on);
+static void growQueue(CallQueue* queue);
+
+/* ****************************************************************************
+ * NAME:        createHallCalls
+ *
+ * PURPOSE:     To generate an empty index for floors 0 to numFloors.
+ *
+ * IMPORT:      numFloors - highest floor (>= 1)
+ * EXPORT:      pointer to the index (NULL if numFloors is invalid)
+ * ***************************************************************************/
+HallCalls* createHallCalls(int numFloors)
+{
+    HallCalls* calls = NULL;
+
+    if (numFloors >= 1)
+    {
+        calls = (HallCalls*)malloc(sizeof(HallCalls));
+        calls->numFloors = numFloors;
+        calls->numWords = numFloors / CALL_WORD_BITS + 1;
+        calls->size = 0;
+        for (int dir = CALL_UP; dir <= CALL_DOWN; dir++)
+        {
+            calls->waiting[dir] = (unsigned long long*)calloc(
+                calls->numWords, sizeof(unsigned long long));
+            calls->queues[dir] = (CallQueue*)calloc(numFloors + 1,
+                                                    sizeof(CallQueue));
+        }
+    }
+
+    return calls;
+}
+
+/* ****************************************************************************
+ * NAME:        callDirection
+ *
+ * PURPOSE:     Returns which way a request is going (a request to its own
+ *              floor counts as up).
+ *
+ * IMPORT:      req - the request
+ * EXPORT:      CALL_UP or CALL_DOWN
+ * ***************************************************************************/
+int callDirection(const Request* req)
+{
+    return (req->destination >= req->start) ? CALL_UP : CALL_DOWN;
+}
+
+/* ****************************************************************************
+ * NAME:        addCall
+ *
+ * PURPOSE:     Add a request behind the others waiting on its floor in its
+ *              direction.
+ *
+ * IMPORT:      calls - the index
+ *              req - the request
+ * EXPORT:      Error code (-1 = the request's floor is out of range)
+ * ***************************************************************************/
+int addCall(HallCalls* calls, Request* req)
+{
+    int status = -1;
+
+    if (req->start >= 0 && req->start <= calls->numFloors)
+    {
+        int dir = callDirection(req);
+        CallQueue* queue = &calls->queues[dir][req->start];
+        if (queue->count == queue->room)
+        {
+            growQueue(queue);
+        }
+
+        queue->reqs[(queue->head + queue->count) & (queue->room - 1)] = req;
+        queue->count++;
+        setWaiting(calls, req->start, dir, 1);
+        calls->size++;
+        status = 0;
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        removeCall
+ *
+ * PURPOSE:     Remove a request taken some other way (e.g. popped from the
+ *              buffer). The oldest call on its floor is removed in O(1);
+ *              any other is searched for in its floor's queue, and the
+ *              calls behind it moved up.
+ *
+ * IMPORT:      calls - the index
+ *              req - the request
+ * EXPORT:      Error code (-1 = the request wasn't waiting)
+ * ***************************************************************************/
+int removeCall(HallCalls* calls, Request* req)
+{
+    int status = -1;
+
+    if (req->start >= 0 && req->start <= calls->numFloors)
+    {
+        int dir = callDirection(req);
+        CallQueue* queue = &calls->queues[dir][req->start];
+        int mask = queue->room - 1;
+
+        if (queue->count > 0 && queue->reqs[queue->head] == req)
+        {
+            queue->head = (queue->head + 1) & mask;
+            queue->count--;
+            calls->size--;
+            status = 0;
+        }
+
+        // Out of order: find it, then close the gap
+        for (int ii = 1; ii < queue->count && status == -1; ii++)
+        {
+            if (queue->reqs[(queue->head + ii) & mask] == req)
+            {
+                for (int jj = ii; jj < queue->count - 1; jj++)
+                {
+                    queue->reqs[(queue->head + jj) & mask] =
+                        queue->reqs[(queue->head + jj + 1) & mask];
+                }
+                queue->count--;
+                calls->size--;
+                status = 0;
+            }
+        }
+
+        if (queue->count == 0)
+        {
+            setWaiting(calls, req->start, dir, 0);
+        }
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        takeCall
+ *
+ * PURPOSE:     Remove and return the oldest request waiting on a floor in a
+ *              direction.
+ *
+ * IMPORT:      calls - the index
+ *              floor - the floor
+ *              dir - CALL_UP or CALL_DOWN
+ * EXPORT:      Pointer to the request (NULL if there is none)
+ * ***************************************************************************/
+Request* takeCall(HallCalls* calls, int floor, int dir)
+{
+    Request* req = NULL;
+
+    if (floor >= 0 && floor <= calls->numFloors &&
+        calls->queues[dir][floor].count > 0)
+    {
+        CallQueue* queue = &calls->queues[dir][floor];
+        req = queue->reqs[queue->head];
+        removeCall(calls, req);
+    }
+
+    return req;
+}
+
+/* ****************************************************************************
+ * NAME:        nearestCall
+ *
+ * PURPOSE:     Find the nearest floor with a call in a lift's direction of
+ *              travel: at or above its floor going up, at or below going
+ *              down. The first word is masked to the floors ahead of the
+ *              lift, then each word is bit-scanned.
+ *
+ * IMPORT:      calls - the index
+ *              floor - the lift's floor
+ *              dir - CALL_UP or CALL_DOWN
+ * EXPORT:      The floor (-1 if there is no call that way)
+ * ***************************************************************************/
+int nearestCall(HallCalls* calls, int floor, int dir)
+{
+    int found = -1;
+
+    if (floor >= 0 && floor <= calls->numFloors)
+    {
+        unsigned long long* words = calls->waiting[dir];
+        int word = floor / CALL_WORD_BITS;
+        int bit = floor % CALL_WORD_BITS;
+
+        if (dir == CALL_UP)
+        {
+            unsigned long long ahead = words[word] & (~0ULL << bit);
+            while (ahead == 0 && ++word < calls->numWords)
+            {
+                ahead = words[word];
+            }
+            if (ahead != 0)
+            {
+                found = word * CALL_WORD_BITS + __builtin_ctzll(ahead);
+            }
+        }
+        else
+        {
+            unsigned long long ahead = words[word] &
+                                       (~0ULL >> (CALL_WORD_BITS - 1 - bit));
+            while (ahead == 0 && --word >= 0)
+            {
+                ahead = words[word];
+            }
+            if (ahead != 0)
+            {
+                found = word * CALL_WORD_BITS + CALL_WORD_BITS - 1 -
+                        __builtin_clzll(ahead);
+            }
+        }
+    }
+
+    return found;
+}
+
+/* ****************************************************************************
+ * NAME:        setWaiting
+ *
+ * PURPOSE:     Set or clear a floor's bit in a direction's bitmap.
+ *
+ * IMPORT:      calls - the index
+ *              floor - the floor
+ *              dir - CALL_UP or CALL_DOWN
+ *              on - 1 = calls waiting, 0 = none
+ * ***************************************************************************/
+static void setWaiting(HallCalls* calls, int floor, int dir, int on)
+{
+    unsigned long long bit = 1ULL << (floor % CALL_WORD_BITS);
+
+    if (on)
+    {
+        calls->waiting[dir][floor / CALL_WORD_BITS] |= bit;
+    }
+    else
+    {
+        calls->waiting[dir][floor / CALL_WORD_BITS] &= ~bit;
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        growQueue
+ *
+ * PURPOSE:     Double a full queue's room, unwrapping it so the oldest call
+ *              is first again.
+ *
+ * IMPORT:      queue - the queue
+ * ***************************************************************************/
+static void growQueue(CallQueue* queue)
+{
+    int room = (queue->room == 0) ? 4 : queue->room * 2;
+    Request** reqs = (Request**)malloc(sizeof(Request*) * room);
+
+    for (int ii = 0; ii < queue->count; ii++)
+    {
+        reqs[ii] = queue->reqs[(queue->head + ii) & (queue->room - 1)];
+    }
+
+    free(queue->reqs);
+    queue->reqs = reqs;
+    queue->head = 0;
+    queue->room = room;
+}
+
+/* ****************************************************************************
+ * NAME:        freeHallCalls
+ *
+ * PURPOSE:     Free the index. The requests belong to the buffer and are
+ *              left alone.
+ *
+ * IMPORT:      Pointer to the index
+ * ***************************************************************************/
+void freeHallCalls(HallCalls* calls)
+{
+    for (int dir = CALL_UP; dir <= CALL_DOWN; dir++)
+    {
+        for (int ii = 0; ii <= calls->numFloors; ii++)
+        {
+            free(calls->queues[dir][ii].reqs);
+        }
+        free(calls->queues[dir]);
+        free(calls->waiting[dir]);
+    }
+
+    free(calls);
+}
@@ -0,0 +1,53 @@
+/* ****************************************************************************
+ * FILE:        hall_calls.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Header file for hall_calls.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include "linked_list.h"
+
+#ifndef HALL_CALLS
+#define HALL_CALLS
+
+// Direction of a call: up if the request's destination is above its start
+#define CALL_UP 0
+#define CALL_DOWN 1
+
+#define CALL_WORD_BITS 64
+
+// The requests waiting on one floor in one direction, oldest first, in a
+// ring: reqs[head] is the oldest, and room is always a power of two
+typedef struct CallQueue
+{
+    Request** reqs;
+    int head;
+    int count;
+    int room;
+} CallQueue;
+
+// Every waiting request, by floor and direction.
+// waiting[dir] = bitmap of floors with a call in that direction (bit n =
+// floor n), so the nearest call is a bit-scan rather than a scan of every
+// request. queues[dir][floor] = the calls themselves.
+typedef struct HallCalls
+{
+    int numFloors;
+    int numWords;
+    int size;
+    unsigned long long* waiting[2];
+    CallQueue* queues[2];
+} HallCalls;
+
+#endif
+
+// Prototype Declarations
+HallCalls* createHallCalls(int numFloors);
+int callDirection(const Request* req);
+int addCall(HallCalls* calls, Request* req);
+int removeCall(HallCalls* calls, Request* req);
+Request* takeCall(HallCalls* calls, int floor, int dir);
+int nearestCall(HallCalls* calls, int floor, int dir);
+void freeHallCalls(HallCalls* calls);
@@ -5,18 +5,26 @@
  *
  * PURPOSE:     Header file for implementations A and B.
  *
- * LAST MOD:    14/04/20 
+ * LAST MOD:    19/10/26 
  * ***************************************************************************/
 
 // Constants
 #define SIM_INPUT "sim_input.csv"
-#define SYNTAX "./lift_sim_A/B <buffer-size> <lift-delay> <optional_input_file>"
-#define ERR "buffer should be >= 1, lift-delay should be >= 0"
+#define SYNTAX "./lift_sim_A/B <buffer-size> <lift-delay> <optional_input_file> [--analyze <trace>] [--solve <trace>] [--lifts <n>] [--producers <n>] [--pin] [--cpus <list>] [--metrics <socket>] [--trace <file.json>] [--output prose|csv|summary|none] [--output-backend stdio|batch] [--quiet] [--summary <file>] [--checkpoint <file> [--resume]] [--travel <floor_ms,accel_ms,door_ms>] [--virtual]"
+#define ERR "buffer should be >= 1, lift-delay (seconds, e.g. 0.25) should be >= 0"
 
 #define GROUND_FLOOR 1
 #define NUM_FLOORS 20
 
-#define NUM_LIFTS 3
+#define NUM_LIFTS 3 // default, see --lifts
+#define MAX_LIFTS 1024
+
+#define NUM_PRODUCERS 1 // default, see --producers (A)
+#define MAX_PRODUCERS 64
+
+// Requests are routed to buildings by an optional third input column
+#define DEFAULT_BUILDING 1
+#define MAX_BUILDINGS 64
 
 // Min and Max number of requests for a given file
 #define MIN_REQ 50
@@ -25,7 +33,21 @@
 #ifndef LIFT
 #define LIFT
 
+#include "cache.h"
+
+struct Building;
+struct TraceThread;
+struct TravelModel;
+struct Topology;
+
 // Struct for representing lifts
+// building = the building the lift serves (NULL if there is only one)
+// trace = the lift thread's trace buffer (see trace.c)
+// delay = fixed overhead of every leg in ms, travel = how long legs take
+// travelMs = total time spent travelling (real or virtual)
+// cpu = the CPU the lift's thread or process is pinned to (-1 = not pinned)
+// Each lift is only ever updated by its own thread, so every lift takes up
+// a whole cache line to stop neighbouring lifts in an array false sharing.
 typedef struct Lift
 {
     int id;
@@ -33,13 +55,31 @@ typedef struct Lift
     int delay;
     int numRequests;
     int numMovements;
-} Lift;
+    int cpu;
+    long long travelMs;
+    struct Building* building;
+    struct TraceThread* trace;
+    const struct TravelModel* travel;
+} CACHE_ALIGNED Lift;
 
 #endif
 
+#include "options.h"
+
 // Protoype Declarations
 int main(int argc, char *argv[]);
-void startSim(int bufferSize, int liftDelay, char* filename);
+void startSim(Options* opts);
+struct Building** createBuildings(int numBuildings, Options* opts, 
+                                  const struct Topology* topo);
+void runBuildings(struct Building** buildings, int numBuildings, Options* opts);
+void spawnLift(int ii);
+void runLift(int self);
+void liftDied(int sig);
+void stopSim(int sig);
+void reapLifts(int options);
+void recoverLift(int ii);
+void lockArena(void);
+void printProcStats(void);
 void* request(void* arg);
 void* lift(void* arg);
 void move(Lift* lift, int to);
\ No newline at end of file
@@ -18,25 +18,56 @@
  * 
  *              Implementation A was made using threads and the pthread library
  *              to address and solve synchronisation issues.
+ * 
+ *              Implementation A can also simulate a whole campus: requests
+ *              carrying a building id in a third column are routed to that
+ *              building, and each building runs its own buffer, lifts and
+ *              counters (pinned to their own CPUs with --pin, see 
+ *              building.c).
+ *
+ *              A building can have several request threads (--producers),
+ *              each adding the requests of its own stream to the one 
+ *              buffer. Requests are numbered as they are logged, under a
+ *              log lock of their own rather than the buffer lock, 
+ *              whichever thread logs them, so the log still counts from 1
+ *              up.
  *
- * LAST MOD:    14/04/20 
+ *              Lifts don't need to know how many requests are coming: the
+ *              last request thread to finish closes the building, and lifts
+ *              stop once it is closed and empty. 
+ *              SIGINT closes every building early. Each lift finishes the 
+ *              request it is serving, and the rest are left in the buffer 
+ *              (and in the final checkpoint, if there is one). The stats,
+ *              summary and trace are still written.
+ *
+ * LAST MOD:    19/10/26 
  * ***************************************************************************/
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <signal.h>
 #include <string.h>
 #include "lift_sim.h"
 #include "fileio.h"
 #include "linked_list.h"
-#include "buffer.h"
+#include "priority_buffer.h"
+#include "building.h"
+#include "metrics.h"
+#include "checkpoint.h"
+#include "output.h"
+#include "analyze.h"
+#include "solve.h"
+#include "trace.h"
+#include "travel.h"
+#include "topology.h"
+
+// Set by SIGINT (see stopSim), read by every thread through isInterrupted
+static int interrupted = 0;
 
-// Initialise shared memory
-int numRequestsServed, totalRequests;
-Buffer* buffer;
-pthread_mutex_t bufLock = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t bufNotFull = PTHREAD_COND_INITIALIZER;
-pthread_cond_t bufNotEmpty = PTHREAD_COND_INITIALIZER;
+static int isInterrupted(void);
+static void logRequest(Building* building, Request* req);
 
 /* ****************************************************************************
  * NAME:        main
@@ -44,37 +75,27 @@ pthread_cond_t bufNotEmpty = PTHREAD_COND_INITIALIZER;
  * IMPORT:      Takes three command line parameters:
  *              1. Buffer Size, i.e. max number of requests that can sit in the 
  *                 buffer at a given time (Integer >= 1)
- *              2. Lift Delay in seconds (Integer >= 0)
+ *              2. Lift Delay in seconds (Number >= 0, e.g. 0.25)
  *              3. (optional) specific input file
+ *              followed by optional flags (see options.c)
  * ***************************************************************************/
 int main(int argc, char *argv[])
 {
-    int bufferSize;
-    int liftDelay;
-
-    if (argc < 3 || argc > 4)
-    {
-        printf("wrong args: format = %s\n", SYNTAX);
-    }
-    else
+    Options opts;
+    if (parseOptions(argc, argv, &opts) == 0)
     {
-        bufferSize = atoi(argv[1]);
-        liftDelay = atoi(argv[2]);
-
-        if (bufferSize <= 0 || liftDelay < 0)
+        if (opts.analyzePath != NULL)
+        {
+            analyzeTrace(opts.analyzePath);
+        }
+        else if (opts.solvePath != NULL)
         {
-            printf("Error: %s\n", ERR);
+            solveTrace(opts.solvePath, &opts);
         }
         else
         {
-            if (argv[3] != NULL)
-            {
-                startSim(bufferSize, liftDelay, argv[3]);
-            }
-            else
-            {
-                startSim(bufferSize, liftDelay, SIM_INPUT);
-            }
+            selectOutput(opts.outputMode, opts.quiet, opts.outputBackend);
+            startSim(&opts);
         }
     }
 
@@ -85,192 +106,666 @@ int main(int argc, char *argv[])
  * NAME:        startSim
  * 
  * PURPOSE:     Start and close the simulation by reading the input file for 
- *              requests, initialising a buffer, spawning / joining threads, and
- *              eventually freeing all malloc'd memory.
+ *              requests, routing them to their buildings, spawning / joining 
+ *              every building's threads, and eventually freeing all malloc'd 
+ *              memory.
  * 
- * IMPORT:      bufferSize - size of the buffer to initialise
- *              liftDelay - seconds to delay lift operations
- *              filename - input file
+ * IMPORT:      opts - buffer size, lift delay, input file and flags
  * ***************************************************************************/
-void startSim(int bufferSize, int liftDelay, char* filename)
+void startSim(Options* opts)
 {
-    buffer = createBuffer(bufferSize);
+    char* filename = opts->filename;
+
     LinkedList* requests = createLinkedList();
+    Topology topo;
 
     int stat = readRequests(filename, requests, GROUND_FLOOR, NUM_FLOORS);
     if (stat == -1)
     {
         printf("failed to read %s\n", filename);
-        free(requests);
-        freeBuffer(buffer);
+        freeLinkedList(requests);
     }
-    else if(requests->size < 50 || requests->size > 100)
+    else if (opts->pin == 1 && readTopology(opts->cpuList, &topo) == -1)
     {
-        printf("the sim can only accomodate %d-%d requests\n", MIN_REQ, MAX_REQ);
-        free(requests);
-        freeBuffer(buffer);
+        freeLinkedList(requests);
     }
     else
     {
-        // Create requests thread
-        totalRequests = requests->size;
-        numRequestsServed = 0;
-        pthread_t lift_r;
-        pthread_create(&lift_r, NULL, request, requests);
-
-        // Create lift threads
-        pthread_t lift_t[3];
-        Lift** lifts = (Lift**)malloc(sizeof(Lift*) * NUM_LIFTS);
-        for (int ii = 0; ii < NUM_LIFTS; ii++)
+        // Route requests to their buildings
+        int numBuildings = countBuildings(requests);
+        Building** buildings = createBuildings(numBuildings, opts, 
+                                               opts->pin ? &topo : NULL);
+        routeRequests(requests, buildings, numBuildings);
+
+        // Every building that has requests must be within the sim's limits
+        int valid = 1;
+        if (numBuildings == 0)
         {
-            lifts[ii] = (Lift*)malloc(sizeof(Lift));
-            lifts[ii]->id = ii + 1;
-            lifts[ii]->currFloor = 1;
-            lifts[ii]->delay = liftDelay;
-            lifts[ii]->numRequests = 0;
-            lifts[ii]->numMovements = 0;
-            pthread_create(&lift_t[ii], NULL, lift, lifts[ii]);
+            printf("the sim can only accomodate %d-%d requests\n", 
+                    MIN_REQ, MAX_REQ);
+            valid = 0;
+        }
+        for (int ii = 0; ii < numBuildings; ii++)
+        {
+            int size = buildings[ii]->totalRequests;
+            if (size != 0 && (size < MIN_REQ || size > MAX_REQ))
+            {
+                printf("the sim can only accomodate %d-%d requests ", 
+                        MIN_REQ, MAX_REQ);
+                printf("(building %d has %d)\n", ii + 1, size);
+                valid = 0;
+            }
         }
 
-        // Join threads and discard lifts
-        pthread_join(lift_r, NULL);
-        for (int ii = 0; ii < NUM_LIFTS; ii++)
+        // Carry on from a checkpoint, or start every output file afresh
+        if (valid == 1 && opts->resume == 1)
         {
-            pthread_join(lift_t[ii], NULL);
-            free(lifts[ii]);
+            if (resumeCheckpoint(opts->checkpointPath, buildings, 
+                                 numBuildings) == -1)
+            {
+                printf("failed to resume from %s\n", opts->checkpointPath);
+                valid = 0;
+            }
+        }
+        else if (valid == 1)
+        {
+            for (int ii = 0; ii < numBuildings; ii++)
+            {
+                remove(buildings[ii]->outFile.name);
+                simOutput->begin(&buildings[ii]->outFile);
+            }
         }
 
-        // Free everything else
-        free(lifts);
-        free(requests); //freeLinkedList()??
-        freeBuffer(buffer);
+        // Report where every thread will run
+        if (valid == 1 && opts->pin == 1)
+        {
+            printTopology(&topo);
+            for (int ii = 0; ii < numBuildings; ii++)
+            {
+                if (buildings[ii]->totalRequests > 0)
+                {
+                    char title[32];
+                    snprintf(title, sizeof(title), "Building %d", ii + 1);
+                    printPlacement(&topo, title, buildings[ii]->core,
+                                   buildings[ii]->lifts, opts->numLifts);
+                }
+            }
+        }
+
+        if (valid == 1)
+        {
+            for (int ii = 0; ii < numBuildings; ii++)
+            {
+                if (buildings[ii]->totalRequests > 0 &&
+                    simOutput->open(&buildings[ii]->outFile) == -1)
+                {
+                    printf("failed to open %s\n",
+                           buildings[ii]->outFile.name);
+                    valid = 0;
+                }
+            }
+        }
+
+        if (valid == 1)
+        {
+            runBuildings(buildings, numBuildings, opts);
+        }
+
+        // Write out whatever is still batched
+        for (int ii = 0; ii < numBuildings; ii++)
+        {
+            if (buildings[ii]->totalRequests > 0)
+            {
+                simOutput->close(&buildings[ii]->outFile);
+            }
+        }
+
+        // Free everything
+        for (int ii = 0; ii < numBuildings; ii++)
+        {
+            freeBuilding(buildings[ii]);
+        }
+        free(buildings);
+        freeLinkedList(requests);
     }  
 }
 
+/* ****************************************************************************
+ * NAME:        createBuildings
+ * 
+ * PURPOSE:     Create every building of the campus. By default no thread
+ *              is pinned, and the scheduler spreads them. When pinning,
+ *              each building's producer and then its lifts take the next 
+ *              CPUs of the placement list, and the building is created 
+ *              while running on its producer's CPU, so its buffer and lifts
+ *              are first touched (and so placed) on the producer's node.
+ * 
+ * IMPORT:      numBuildings - number of buildings
+ *              opts - buffer size, lift delay, lifts and travel model
+ *              topo - where to place threads (NULL = don't pin)
+ * EXPORT:      array of buildings
+ * ***************************************************************************/
+Building** createBuildings(int numBuildings, Options* opts, 
+                           const Topology* topo)
+{
+    Building** buildings = (Building**)malloc(sizeof(Building*) * 
+                                              numBuildings);
+
+    for (int ii = 0; ii < numBuildings; ii++)
+    {
+        int slot = ii * (opts->numLifts + 1);
+        if (topo != NULL)
+        {
+            pinSelf(placeCpu(topo, slot));
+        }
+
+        buildings[ii] = createBuilding(ii + 1, opts->bufferSize, 
+                                       opts->numLifts, opts->liftDelay, 
+                                       &opts->travel, opts->dispatch);
+
+        if (topo != NULL)
+        {
+            buildings[ii]->core = placeCpu(topo, slot);
+            for (int jj = 0; jj < opts->numLifts; jj++)
+            {
+                buildings[ii]->lifts[jj].cpu = placeCpu(topo, slot + 1 + jj);
+            }
+        }
+    }
+
+    // The other threads (metrics, checkpoints) are free to run anywhere
+    if (topo != NULL)
+    {
+        unpinSelf(topo);
+    }
+
+    return buildings;
+}
+
+/* ****************************************************************************
+ * NAME:        runBuildings
+ * 
+ * PURPOSE:     Spawn the request threads and lift threads of every building 
+ *              (pinned where createBuildings placed them, if it did), join 
+ *              them all, and report per-building and aggregate stats. Live
+ *              metrics, a timeline trace, checkpoints and a summary file 
+ *              are produced if asked for.
+ * 
+ * IMPORT:      buildings - array of buildings
+ *              numBuildings - length of the array
+ *              opts - command line flags
+ * ***************************************************************************/
+void runBuildings(Building** buildings, int numBuildings, Options* opts)
+{
+    MetricsServer* metrics = NULL;
+    if (opts->metricsPath != NULL)
+    {
+        metrics = startMetrics(opts->metricsPath, buildings, numBuildings);
+    }
+
+    Checkpointer* checkpoints = NULL;
+    if (opts->checkpointPath != NULL)
+    {
+        checkpoints = startCheckpoints(opts->checkpointPath, buildings, 
+                                       numBuildings);
+    }
+
+    Trace* trace = NULL;
+    if (opts->tracePath != NULL)
+    {
+        trace = openTrace(opts->tracePath);
+        for (int ii = 0; ii < numBuildings; ii++)
+        {
+            buildings[ii]->trace = trace;
+        }
+    }
+
+    // Stop cleanly on the first SIGINT, and die on the next
+    struct sigaction sa;
+    sa.sa_handler = stopSim;
+    sa.sa_flags = SA_RESETHAND;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+
+    pthread_t* lift_r = (pthread_t*)malloc(sizeof(pthread_t) * numBuildings *
+                                           opts->numProducers);
+    pthread_t* lift_t = (pthread_t*)malloc(sizeof(pthread_t) * numBuildings *
+                                           opts->numLifts);
+
+    // Create request and lift threads for every building with requests
+    for (int ii = 0; ii < numBuildings; ii++)
+    {
+        Building* building = buildings[ii];
+        if (building->totalRequests > 0)
+        {
+            splitStreams(building, opts->numProducers);
+            for (int jj = 0; jj < building->numProducers; jj++)
+            {
+                pthread_t* thread = &lift_r[ii * opts->numProducers + jj];
+                pthread_create(thread, NULL, request, 
+                               &building->producers[jj]);
+                if (building->core >= 0 && 
+                    pinThread(*thread, building->core) != 0)
+                {
+                    printf("failed to pin Lift-R of building %d to cpu %d\n",
+                           building->id, building->core);
+                }
+            }
+
+            for (int jj = 0; jj < building->numLifts; jj++)
+            {
+                pthread_t* thread = &lift_t[ii * opts->numLifts + jj];
+                pthread_create(thread, NULL, lift, &building->lifts[jj]);
+                if (building->lifts[jj].cpu >= 0 && 
+                    pinThread(*thread, building->lifts[jj].cpu) != 0)
+                {
+                    printf("failed to pin Lift-%d of building %d to cpu %d\n",
+                           jj + 1, building->id, building->lifts[jj].cpu);
+                }
+            }
+        }
+    }
+
+    // Join threads
+    for (int ii = 0; ii < numBuildings; ii++)
+    {
+        if (buildings[ii]->totalRequests > 0)
+        {
+            for (int jj = 0; jj < buildings[ii]->numProducers; jj++)
+            {
+                pthread_join(lift_r[ii * opts->numProducers + jj], NULL);
+            }
+            for (int jj = 0; jj < buildings[ii]->numLifts; jj++)
+            {
+                pthread_join(lift_t[ii * opts->numLifts + jj], NULL);
+            }
+        }
+    }
+
+    stopMetrics(metrics);
+    stopCheckpoints(checkpoints);
+    closeTrace(trace);
+
+    if (opts->summaryPath != NULL)
+    {
+        Summary** summaries = (Summary**)malloc(sizeof(Summary*) * 
+                                                numBuildings);
+        for (int ii = 0; ii < numBuildings; ii++)
+        {
+            summaries[ii] = buildings[ii]->summary;
+        }
+        writeSummary(opts->summaryPath, summaries, numBuildings);
+        free(summaries);
+    }
+
+    // Report hot-path counters (only when compiled with PROFILE)
+    for (int ii = 0; ii < numBuildings; ii++)
+    {
+        if (buildings[ii]->totalRequests > 0)
+        {
+            char title[32];
+            snprintf(title, sizeof(title), "Profile of building %d", 
+                     buildings[ii]->id);
+            PROF_DUMP(buildings[ii]->profiles, 0, buildings[ii]->numLifts + 1,
+                      title);
+        }
+    }
+
+    // Report stats (only worth it for more than one building, or to show
+    // how far an interrupted sim got)
+    if (isInterrupted())
+    {
+        printf("Interrupted, stopping early\n");
+    }
+    if (numBuildings > 1 || isInterrupted())
+    {
+        int served = 0, total = 0, movements = 0;
+        for (int ii = 0; ii < numBuildings; ii++)
+        {
+            if (buildings[ii]->totalRequests > 0)
+            {
+                printBuildingStats(buildings[ii]);
+                served += buildings[ii]->numRequestsServed;
+                total += buildings[ii]->totalRequests;
+                movements += buildingMovements(buildings[ii]);
+            }
+        }
+        if (numBuildings > 1)
+        {
+            printf("Campus: %d/%d requests served, %d movements\n", 
+                    served, total, movements);
+        }
+    }
+    else if (buildings[0]->summary->classes[0].requests < 
+             buildings[0]->summary->requests)
+    {
+        // Waits per priority class, if the input used any
+        printf("Building 1 (%s):\n", buildings[0]->outFile.name);
+        printClassStats(buildings[0]->summary);
+    }
+
+    free(lift_r);
+    free(lift_t);
+}
+
+/* ****************************************************************************
+ * NAME:        stopSim
+ * 
+ * PURPOSE:     SIGINT handler. Only raises a flag: the request threads see
+ *              it before adding their next request and stop (closing their 
+ *              buildings), and lifts see it before taking another request.
+ * 
+ * IMPORT:      sig - the signal number
+ * ***************************************************************************/
+void stopSim(int sig)
+{
+    __atomic_store_n(&interrupted, 1, __ATOMIC_RELAXED);
+}
+
+/* ****************************************************************************
+ * NAME:        isInterrupted
+ * 
+ * PURPOSE:     Returns 1 once SIGINT has been received.
+ * 
+ * EXPORT:      Integer (1 = interrupted)
+ * ***************************************************************************/
+static int isInterrupted(void)
+{
+    return __atomic_load_n(&interrupted, __ATOMIC_RELAXED);
+}
+
 /* ****************************************************************************
  * NAME:        request
  * 
- * PURPOSE:     Function for the Lift-R thread.
- *              This thread is responsible for loading requests from the list
- *              into the buffer. Mutual exclusion is achieved through pthread
- *              locks to ensure the buffer is never accessed while other threads
- *              are in their critical sections.
+ * PURPOSE:     Function for the Lift-R thread(s).
+ *              This thread is responsible for loading requests from its 
+ *              stream into the buffer. Mutual exclusion is achieved through
+ *              pthread locks to ensure the buffer is never accessed while 
+ *              other threads are in their critical sections. Only 
+ *              reserving a request's slot and adding it are done under the
+ *              buffer lock; in between it is numbered and logged under the
+ *              log lock (see logRequest), so lifts and other request 
+ *              threads never wait on the buffer lock while an entry is 
+ *              rendered and written. Once there are no more requests (or 
+ *              the sim is interrupted), the last request thread to stop 
+ *              closes the building and wakes every lift waiting for one.
+ *
+ *              Request threads share the building's first profile; they 
+ *              only update it while holding the lock.
  * 
- * IMPORT       Linked List of requests.
+ * IMPORT       Producer struct - contains the stream and its building
  * ***************************************************************************/
 void* request(void* arg)
 {
-    LinkedList* requests = (LinkedList*)arg;
-    Request* thisReq = removeStart(requests);
+    Producer* producer = (Producer*)arg;
+    Building* building = producer->building;
+    PROF_THREAD(prof, &building->profiles[0]);
+    char name[16];
+    TraceThread tt;
+
+    // Lift-R keeps thread id 0, any others come after the lifts
+    if (building->numProducers == 1)
+    {
+        traceThreadInit(&tt, building->trace, building->id, 0, "Lift-R");
+    }
+    else
+    {
+        snprintf(name, sizeof(name), "Lift-R%d", producer->id);
+        traceThreadInit(&tt, building->trace, building->id, 
+                        producer->id == 1 ? 0 : 
+                        building->numLifts + producer->id - 1, name);
+    }
+    Request* thisReq = removeStart(producer->stream);
 
     while (thisReq != NULL)
     {
-        pthread_mutex_lock(&bufLock); // CRITICAL SECTION START
+        PROF_START(t);
+        traceBegin(&tt, "lock wait");
+        pthread_mutex_lock(&building->bufLock); // CRITICAL SECTION START
+        traceEnd(&tt, "lock wait");
+        PROF_ADD(prof, lockWait, t);
+        PROF_INC(prof, locks);
+        PROF_LAP(t);
+
+        // Wait for a slot nobody has reserved (and for any checkpoint)
+        while ((building->buffer->size + building->numReserved >= 
+                building->buffer->capacity || building->pausing == 1) && 
+               !isInterrupted())
+        {
+            PROF_ADD(prof, lockHeld, t);
+            PROF_LAP(t);
+            traceBegin(&tt, "buffer full");
+            pthread_cond_wait(&building->bufNotFull, &building->bufLock);
+            traceEnd(&tt, "buffer full");
+            PROF_ADD(prof, notFullWait, t);
+            PROF_INC(prof, notFullWaits);
+            PROF_LAP(t);
+        }
 
-        if (isFull(buffer))
+        int reserved = 0;
+        if (isInterrupted())
         {
-            pthread_cond_wait(&bufNotFull, &bufLock);
+            // The rest stay in the stream (freed with the building)
+            free(thisReq);
         }
+        else
+        {
+            building->numReserved++;
+            reserved = 1;
+        }
+        PROF_ADD(prof, lockHeld, t);
+        pthread_mutex_unlock(&building->bufLock); // CRITICAL SECTION END
+
+        // Once reserved, a request is always logged and added, even if the
+        // sim is interrupted meanwhile
+        if (reserved == 1)
+        {
+            logRequest(building, thisReq);
+
+            PROF_LAP(t);
+            pthread_mutex_lock(&building->bufLock); // CRITICAL SECTION START
+            PROF_ADD(prof, lockWait, t);
+            PROF_INC(prof, locks);
+            PROF_LAP(t);
 
-        printf("NEW REQUEST: %d to %d\n", thisReq->start, thisReq->destination);
-        addToBuffer(buffer, thisReq);
-        writeRequest(thisReq);
+            thisReq->queuedNs = profileNow();
+            addToPriorityBuffer(building->buffer, thisReq);
+            __atomic_store_n(&building->numRequestsPushed, 
+                             building->numRequestsPushed + 1, 
+                             __ATOMIC_RELAXED);
+            building->numReserved--;
+            if (building->numReserved == 0 && building->pausing == 1)
+            {
+                pthread_cond_broadcast(&building->allPushed);
+            }
+            traceInstant(&tt, "enqueue", thisReq->num);
+            PROF_INC(prof, items);
 
-        pthread_cond_signal(&bufNotEmpty);
-        pthread_mutex_unlock(&bufLock); // CRITICAL SECTION END
+            pthread_cond_signal(&building->bufNotEmpty);
+            PROF_ADD(prof, lockHeld, t);
+            pthread_mutex_unlock(&building->bufLock); // CRITICAL SECTION END
+        }
 
-        thisReq = removeStart(requests);
+        thisReq = isInterrupted() ? NULL : removeStart(producer->stream);
     }
 
+    // End of every stream: lifts waiting on an empty buffer can stop
+    pthread_mutex_lock(&building->bufLock);
+    building->openProducers--;
+    if (building->openProducers == 0)
+    {
+        building->closed = 1;
+        pthread_cond_broadcast(&building->bufNotEmpty);
+    }
+    pthread_mutex_unlock(&building->bufLock);
+
+    traceFlush(&tt);
+
     return 0;
 }
 
+/* ****************************************************************************
+ * NAME:        logRequest
+ * 
+ * PURPOSE:     Number and log a request whose slot is reserved, under the
+ *              building's log lock, so numbers follow the log order.
+ * 
+ * IMPORT       building - the building
+ *              req - the request
+ * ***************************************************************************/
+static void logRequest(Building* building, Request* req)
+{
+    pthread_mutex_lock(&building->logLock);
+    building->numRequestsLogged++;
+    req->num = building->numRequestsLogged;
+    simOutput->echoRequest(req);
+    simOutput->request(req, &building->outFile);
+    pthread_mutex_unlock(&building->logLock);
+}
+
 /* ****************************************************************************
  * NAME:        lift
  * 
  * PURPOSE:     Function for the Lift-x thread.
  *              This thread is responsible for extracting requests from the 
  *              buffer and processing the lift's operation on the request. 
- *              Mutual exclusion is ensured through pthread locks.
+ *              Mutual exclusion is ensured through pthread locks. It stops
+ *              once the building is closed and the buffer empty, or after 
+ *              its current request if the sim is interrupted.
  * 
- * IMPORT       Lift struct - contains lift state
+ * IMPORT       Lift struct - contains lift state (and its building)
  * ***************************************************************************/
 void* lift(void* arg)
 {
     Lift* lift = (Lift*)arg;
+    Building* building = lift->building;
+    PROF_THREAD(prof, &building->profiles[lift->id]);
+    char name[16];
+    TraceThread tt;
     Request* req;
+    int dir = CALL_UP; // way of its last trip, for --dispatch nearest
+
+    snprintf(name, sizeof(name), "Lift-%d", lift->id);
+    traceThreadInit(&tt, building->trace, building->id, lift->id, name);
+    lift->trace = &tt;
     
     int finished = 0;
     while (finished != 1)
     {
-        pthread_mutex_lock(&bufLock); // CRITICAL SECTION START
+        PROF_START(t);
+        traceBegin(&tt, "lock wait");
+        pthread_mutex_lock(&building->bufLock); // CRITICAL SECTION START
+        traceEnd(&tt, "lock wait");
+        PROF_ADD(prof, lockWait, t);
+        PROF_INC(prof, locks);
+        PROF_LAP(t);
 
-        // End loop if there are no more requests
-        if (numRequestsServed >= totalRequests)
+        // Wait and release the lock if buffer is empty
+        if (isPriorityEmpty(building->buffer) && !building->closed &&
+            !isInterrupted())
         {
-            finished = 1;
-            pthread_mutex_unlock(&bufLock);
+            PROF_ADD(prof, lockHeld, t);
+            PROF_LAP(t);
+            traceBegin(&tt, "buffer empty");
+            pthread_cond_wait(&building->bufNotEmpty, &building->bufLock);
+            traceEnd(&tt, "buffer empty");
+            PROF_ADD(prof, notEmptyWait, t);
+            PROF_INC(prof, notEmptyWaits);
+            PROF_LAP(t);
         }
-        else
-        {
-            // Wait and release the lock if buffer is empty
-            if (isEmpty(buffer))
-            {
-                pthread_cond_wait(&bufNotEmpty, &bufLock);
-            }
 
-            req = popBuffer(buffer);
+        // Once interrupted, whatever is still queued stays there
+        req = isInterrupted() ? NULL : popNearest(building->buffer, 
+                                                  lift->currFloor, dir);
 
-            // Serve request (if there is one)
-            if (req != NULL)
-            {
-                // Write acitvity to log
-                lift->numRequests++;
-                writeLiftActivity(lift, req);
-
-                // Add to num served before releasing mutex
-                numRequestsServed++;
-                pthread_cond_signal(&bufNotFull);
-                pthread_mutex_unlock(&bufLock);
-
-                // Serve
-                if (lift->currFloor != req->start)
-                {
-                    move(lift, req->start);
-                }
+        // Serve request (if there is one)
+        if (req != NULL)
+        {
+            // Write acitvity to log (before the slot can be reserved 
+            // again, so the log never shows more queued than fit)
+            traceInstant(&tt, "dequeue", req->num);
+            __atomic_store_n(&lift->numRequests, lift->numRequests + 1,
+                             __ATOMIC_RELAXED);
+            pthread_mutex_lock(&building->logLock);
+            simOutput->activity(lift, req, &building->outFile);
+            pthread_mutex_unlock(&building->logLock);
+            saveLiftState(&building->saved[lift->id - 1], lift, req);
+            recordRequest(building->summary, lift->id - 1, 
+                          lift->currFloor, req, 
+                          profileNow() - req->queuedNs);
+            PROF_INC(prof, items);
 
-                move(lift, req->destination);
+            // Add to num served before releasing mutex (an atomic store, as
+            // the metrics thread reads it without the lock)
+            __atomic_store_n(&building->numRequestsServed, 
+                             building->numRequestsServed + 1, 
+                             __ATOMIC_RELAXED);
+            pthread_cond_signal(&building->bufNotFull);
+            PROF_ADD(prof, lockHeld, t);
+            pthread_mutex_unlock(&building->bufLock);
 
-                // Request no longer needed
-                free(req);
-            }
-            else
+            // Serve
+            if (lift->currFloor != req->start)
             {
-                pthread_cond_signal(&bufNotFull);
-                pthread_mutex_unlock(&bufLock); // CRITICAL SECTION END
+                move(lift, req->start);
             }
+
+            move(lift, req->destination);
+
+            // Request no longer needed
+            dir = callDirection(req);
+            free(req);
+        }
+        else if (building->closed || isInterrupted())
+        {
+            // End loop if there are no more requests (request threads
+            // may still be waiting for room, to find out it was interrupted)
+            finished = 1;
+            pthread_cond_broadcast(&building->bufNotFull);
+            PROF_ADD(prof, lockHeld, t);
+            pthread_mutex_unlock(&building->bufLock); // CRITICAL SECTION END
+        }
+        else
+        {
+            PROF_INC(prof, nullPops);
+            pthread_cond_signal(&building->bufNotFull);
+            PROF_ADD(prof, lockHeld, t);
+            pthread_mutex_unlock(&building->bufLock); // CRITICAL SECTION END
         }
     }
 
+    traceFlush(&tt);
+    lift->trace = NULL;
+
     return 0;
 }
 
 /* ****************************************************************************
  * NAME:        move
  * 
- * PURPOSE:     Processes a lift operation.
+ * PURPOSE:     Processes a lift operation, taking as long as the travel 
+ *              model says the leg takes (or no time at all, in virtual time).
  * 
  * IMPORT       lift - the lift struct
  *              to - an Integer describing the destination floor
  * ***************************************************************************/
 void move(Lift* lift, int to)
 {
-    printf("lift %d: moving from %d to %d\n", 
-            lift->id, lift->currFloor, to);
+    int ms = legTimeMs(lift->travel, lift->delay, abs(lift->currFloor - to));
 
-    sleep(lift->delay);
+    simOutput->echoMove(lift, to);
+
+    traceMoveBegin(lift->trace, lift->currFloor, to);
+    if (lift->travel == NULL || lift->travel->virtualTime == 0)
+    {
+        sleepMs(ms);
+    }
+    traceEnd(lift->trace, "move");
 
-    // Increment movements
-    lift->numMovements += abs(lift->currFloor - to);
-    lift->currFloor = to;
+    // Increment movements (atomically, see metrics.c)
+    lift->travelMs += ms;
+    __atomic_store_n(&lift->numMovements, 
+                     lift->numMovements + abs(lift->currFloor - to), 
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&lift->currFloor, to, __ATOMIC_RELAXED);
 }
\ No newline at end of file
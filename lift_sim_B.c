@@ -5,7 +5,8 @@
  *
  * PURPOSE:     Implementation B of the Lift Simulator.
  *              
- *              This program simulates 3 lifts servicing a 20 story building
+ *              This program simulates 3 lifts (or as many as given with 
+ *              --lifts) servicing a 20 story building
  *              in synchronous harmony. It can handle 50-100 requests per input
  *              file, where each line in the file is a request formatted as:
  *              "[current_floor] [destination_floor]".
@@ -17,34 +18,112 @@
  *              but work differently 'under the hood'.
  * 
  *              Implementation B was made using processes through system calls. 
- *              Semaphores were used to solve synchronisation issues.
+ *              Semaphores and a robust mutex were used to solve 
+ *              synchronisation issues.
+ * 
+ *              The parent process is Lift-R and forks one process per lift
+ *              from a flat loop. Requests are passed through a lock-free ring
+ *              inside a single shared memory arena (see ring.c). Lifts take
+ *              requests out under a robust process-shared mutex, recording 
+ *              the request in flight, so Lift-R (which supervises the lifts)
+ *              can re-queue it and respawn the lift if a lift process dies.
+ *
+ *              Once Lift-R has pushed its last request it closes the ring
+ *              and wakes every lift once; a lift finding the ring closed 
+ *              and empty exits. SIGINT (which the lifts ignore) makes 
+ *              Lift-R close the ring early, and lifts exit after the 
+ *              request they are serving. The stats are still printed.
  *
- * LAST MOD:    07/05/20 
+ * LAST MOD:    19/10/26 
  * ***************************************************************************/
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
 #include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
 #include <semaphore.h>
 #include <wait.h>
+#include <sys/prctl.h>
 #include <sys/types.h>
 #include <sys/shm.h>
 #include <sys/ipc.h>
 #include "lift_sim.h"
 #include "fileio.h"
 #include "linked_list.h"
-#include "buffer.h"
+#include "ring.h"
+#include "building.h"
+#include "profile.h"
+#include "trace.h"
+#include "travel.h"
+#include "summary.h"
+#include "output.h"
+#include "analyze.h"
+#include "solve.h"
+#include "topology.h"
 
 // Initialise shared memory
+// The arena is one shared memory segment holding this header, then the lifts
+// (so the parent can report on them), then per-process stats, then the 
+// running totals, then the ring.
+// mutex = robust, serialises the lifts taking requests out of the ring
+// full/empty = wake-ups only, the ring itself says whether there is work
+// closed = Lift-R will push no more requests (set under the mutex)
+// interrupted = set by SIGINT, lifts leave what is left in the ring
 typedef struct Shared
 {   
-    int numRequestsServed;
     int totalRequests;
-    Buffer* buffer;
-    sem_t mutex;
+    int numLifts;
+    int bufferSize;
+    int closed;
+    volatile sig_atomic_t interrupted;
+    pthread_mutex_t mutex;
     sem_t full;
     sem_t empty;
+    CACHE_ALIGNED int numRequestsServed;
+    CACHE_ALIGNED long long startNs;
 } Shared;
+
+// What a lift process is doing with the ring (see recoverLift)
+#define LIFT_IDLE 0
+#define LIFT_CLAIMING 1
+#define LIFT_SERVING 2
+
+// Per-process stats, written by the lift process itself
+// inFlight = the request being served while state is LIFT_SERVING
+// servedNum = number of the last request this lift finished serving
+typedef struct ProcStats
+{
+    pid_t pid;
+    int cpu;
+    int state;
+    int restarts;
+    Request inFlight;
+    int servedNum;
+    long long endNs;
+} CACHE_ALIGNED ProcStats;
+
 Shared* shm;
+Lift* lifts;
+ProcStats* procs;
+Summary* summary;
+Ring* ring;
+char* arena;
+
+// Lift-R's view of its children (only meaningful in the parent)
+int liftsRunning;
+volatile sig_atomic_t liftExited;
+
+// Hot-path counters (index 0 = Lift-R, n = Lift-n), private to each process
+Profile* profiles;
+
+// Timeline trace shared by every process (NULL = off)
+Trace* trace;
+
+// The output file every process logs to (never batched)
+OutFile outFile = { OUT_FILE, NULL };
 
 /* ****************************************************************************
  * NAME:        main
@@ -52,37 +131,28 @@ Shared* shm;
  * IMPORT:      Takes three command line parameters:
  *              1. Buffer Size, i.e. max number of requests that can sit in the 
  *                 buffer at a given time (Integer >= 1)
- *              2. Lift Delay in seconds (Integer >= 0)
+ *              2. Lift Delay in seconds (Number >= 0, e.g. 0.25)
  *              3. (optional) specific input file
+ *              followed by optional flags (see options.c)
  * ***************************************************************************/
 int main(int argc, char *argv[])
 {
-    int bufferSize;
-    int liftDelay;
-
-    if (argc < 3 || argc > 4)
-    {
-        printf("wrong args: format = %s\n", SYNTAX);
-    }
-    else
+    Options opts;
+    if (parseOptions(argc, argv, &opts) == 0)
     {
-        bufferSize = atoi(argv[1]);
-        liftDelay = atoi(argv[2]);
-
-        if (bufferSize <= 0 || liftDelay < 0)
+        if (opts.analyzePath != NULL)
+        {
+            analyzeTrace(opts.analyzePath);
+        }
+        else if (opts.solvePath != NULL)
         {
-            printf("Error: %s\n", ERR);
+            solveTrace(opts.solvePath, &opts);
         }
         else
         {
-            if (argv[3] != NULL)
-            {
-                startSim(bufferSize, liftDelay, argv[3]);
-            }
-            else
-            {
-                startSim(bufferSize, liftDelay, SIM_INPUT);
-            }
+            // Batches from several processes would interleave out of order
+            selectOutput(opts.outputMode, opts.quiet, BACKEND_STDIO);
+            startSim(&opts);
         }
     }
 
@@ -93,105 +163,415 @@ int main(int argc, char *argv[])
  * NAME:        startSim
  * 
  * PURPOSE:     Start and close the simulation by reading the input file for 
- *              requests, initialising a buffer, spawning and killing processes, 
- *              and eventually freeing all malloc'd memory (in all processes).
+ *              requests, initialising the shared arena, spawning and killing 
+ *              processes, and eventually freeing all malloc'd memory (in all
+ *              processes).
  * 
- * IMPORT:      bufferSize - size of the buffer to initialise
- *              liftDelay - seconds to delay lift operations
- *              filename - input file
+ * IMPORT:      opts - buffer size, lift delay, input file and flags
  * ***************************************************************************/
-void startSim(int bufferSize, int liftDelay, char* filename)
+void startSim(Options* opts)
 {
+    int bufferSize = opts->bufferSize;
+    int liftDelay = opts->liftDelay;
+    int numLifts = opts->numLifts;
+    char* filename = opts->filename;
+    Topology topo;
+
+    if (opts->metricsPath != NULL)
+    {
+        printf("--metrics is only supported by implementation A\n");
+    }
+    if (opts->checkpointPath != NULL)
+    {
+        printf("--checkpoint is only supported by implementation A\n");
+    }
+    if (opts->numProducers > 1)
+    {
+        printf("--producers is only supported by implementation A\n");
+    }
+    if (opts->outputBackend == BACKEND_BATCH)
+    {
+        printf("--output-backend batch is only supported by "
+               "implementation A\n");
+    }
+    if (opts->dispatch == DISPATCH_NEAREST)
+    {
+        printf("--dispatch nearest is only supported by implementation A\n");
+    }
+
+    remove(OUT_FILE);
+    simOutput->begin(&outFile);
+
     LinkedList* requests = createLinkedList();
     if (readRequests(filename, requests, GROUND_FLOOR, NUM_FLOORS) == -1)
     {
         printf("failed to read %s\n", filename);
         freeLinkedList(requests);
     }
+    else if (opts->pin == 1 && readTopology(opts->cpuList, &topo) == -1)
+    {
+        freeLinkedList(requests);
+    }
     else
     {
-        // Allocate shared memory and attach to address space
-        int shmId_1 = shmget(1000, 1024, 0666 | IPC_CREAT);
-        int shmId_2 = shmget(2000, 1024, 0666 | IPC_CREAT);
-        int shmId_3 = shmget(3000, 1024, 0666 | IPC_CREAT);
-
-        shm = (Shared*)shmat(shmId_1, NULL, 0); 
-        shm->buffer = (Buffer*)shmat(shmId_2, NULL, 0);
-        shm->buffer->buf = (Request**)shmat(shmId_3, NULL, 0);
+        // Lift-R (this process) takes the first CPU before the arena is 
+        // touched, so the arena's pages land on its node
+        if (opts->pin == 1)
+        {
+            pinSelf(placeCpu(&topo, 0));
+        }
 
-        // Initialise shared objects and semaphores
+        // Allocate the shared arena and attach to address space
+        size_t liftsOffset = sizeof(Shared);
+        size_t procsOffset = liftsOffset + sizeof(Lift) * numLifts;
+        size_t summaryOffset = procsOffset + sizeof(ProcStats) * numLifts;
+        size_t ringOffset = summaryOffset + summaryBytes(numLifts);
+        size_t arenaBytes = ringOffset + ringBytes(bufferSize + numLifts);
+
+        // Marked for removal straight away: the segment lives on while any
+        // process is attached, and is freed however the last one exits
+        int shmId = shmget(IPC_PRIVATE, arenaBytes, 0600 | IPC_CREAT);
+        arena = (char*)shmat(shmId, NULL, 0);
+        shmctl(shmId, IPC_RMID, NULL);
+
+        shm = (Shared*)arena;
+        lifts = (Lift*)(arena + liftsOffset);
+        procs = (ProcStats*)(arena + procsOffset);
+        summary = (Summary*)(arena + summaryOffset);
+        ring = (Ring*)(arena + ringOffset);
+
+        // Initialise shared objects and semaphores.
+        // Lift-R never fills the ring past the buffer size, the extra slot 
+        // per lift is room to re-queue the request of a lift that died.
         shm->totalRequests = requests->size;
+        shm->numLifts = numLifts;
+        shm->bufferSize = bufferSize;
         shm->numRequestsServed = 0;
-        sem_init(&shm->mutex, 1, 1);
+        shm->closed = 0;
+        shm->interrupted = 0;
+        shm->startNs = profileNow();
         sem_init(&shm->empty, 1, bufferSize);
         sem_init(&shm->full, 1, 0);
+        initRing(ring, bufferSize + numLifts);
+        initSummary(summary, numLifts);
+
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&shm->mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+
+        // Create Lifts
+        Lift* initial = createLifts(numLifts, liftDelay, &opts->travel);
+        for (int ii = 0; ii < numLifts; ii++)
+        {
+            lifts[ii] = initial[ii];
+            if (opts->pin == 1)
+            {
+                lifts[ii].cpu = placeCpu(&topo, ii + 1);
+            }
+        }
+        free(initial);
 
-        // Initialise Buffer
-        shm->buffer->capacity = bufferSize;
-        shm->buffer->next_in = 0;
-        shm->buffer->next_out = 0;
-        for (int ii = 0; ii < bufferSize; ii++)
+        if (opts->pin == 1)
         {
-            shm->buffer->buf[ii] = NULL; // null means slot is empty
+            printTopology(&topo);
+            printPlacement(&topo, "Building 1", placeCpu(&topo, 0), lifts,
+                           numLifts);
         }
 
-        // Create Lists
-        Lift** lifts = (Lift**)malloc(sizeof(Lift*) * NUM_LIFTS);
-        for (int ii = 0; ii < NUM_LIFTS; ii++)
+        profiles = createProfiles(numLifts + 1);
+
+        trace = NULL;
+        if (opts->tracePath != NULL)
+        {
+            trace = openTrace(opts->tracePath);
+        }
+
+        // Hear about lifts dying, even while blocked on a semaphore
+        struct sigaction sa;
+        sa.sa_handler = liftDied;
+        sa.sa_flags = 0;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGCHLD, &sa, NULL);
+
+        // Stop cleanly on the first SIGINT, and die on the next
+        sa.sa_handler = stopSim;
+        sa.sa_flags = SA_RESETHAND;
+        sigaction(SIGINT, &sa, NULL);
+
+        // Create 1 process for each lift (children never return)
+        liftsRunning = 0;
+        liftExited = 0;
+        for (int ii = 0; ii < numLifts; ii++)
         {
-            lifts[ii] = (Lift*)malloc(sizeof(Lift));
-            lifts[ii]->id = ii + 1;
-            lifts[ii]->currFloor = 1;
-            lifts[ii]->delay = liftDelay;
-            lifts[ii]->numRequests = 0;
-            lifts[ii]->numMovements = 0;
+            spawnLift(ii);
         }
 
-        // Create 3 processes: 1 for each lift
-        pid_t cpid1, cpid2, cpid3;
-        cpid1 = fork();
-        if (cpid1 == 0)
+        // The parent is lift-R (this process)
+        request(requests);
+
+        // Wait for all children to finish up before closing
+        reapLifts(0);
+        signal(SIGINT, SIG_IGN); // the handler uses the arena, freed below
+
+        if (shm->interrupted)
         {
-            cpid2 = fork();
-            if (cpid2 == 0)
+            printf("Interrupted, stopping early\n");
+        }
+        printProcStats();
+        if (opts->summaryPath != NULL)
+        {
+            writeSummary(opts->summaryPath, &summary, 1);
+        }
+
+        // Report hot-path counters (only when compiled with PROFILE)
+        char title[32];
+        snprintf(title, sizeof(title), "Profile of process %d", (int)getpid());
+        PROF_DUMP(profiles, 0, 1, title);
+
+        // Free (the trace is only ended once, by the parent)
+        closeTrace(trace);
+        pthread_mutex_destroy(&shm->mutex);
+        sem_destroy(&shm->empty);
+        sem_destroy(&shm->full);
+        free(profiles);
+        freeLinkedList(requests);
+
+        // Free shared memory (already marked for removal)
+        shmdt(arena);
+    }  
+}
+
+/* ****************************************************************************
+ * NAME:        spawnLift
+ * 
+ * PURPOSE:     Fork the process for a lift. Used at start up, and by Lift-R
+ *              to replace a lift process that died.
+ * 
+ * IMPORT:      ii - index of the lift
+ * ***************************************************************************/
+void spawnLift(int ii)
+{
+    fflush(stdout); // or the child would print Lift-R's pending output again
+
+    pid_t cpid = fork();
+    if (cpid == 0)
+    {
+        runLift(ii + 1);
+    }
+    else if (cpid == -1)
+    {
+        perror("failed to create lift process");
+    }
+    else
+    {
+        procs[ii].pid = cpid;
+        liftsRunning++;
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        runLift
+ * 
+ * PURPOSE:     Body of a lift process, from fork to exit. Never returns.
+ * 
+ * IMPORT:      self - n for Lift-n
+ * ***************************************************************************/
+void runLift(int self)
+{
+    // Don't outlive Lift-R, or nobody would be left to end the sim
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    if (getppid() == 1)
+    {
+        _exit(1);
+    }
+
+    signal(SIGCHLD, SIG_DFL);
+    signal(SIGINT, SIG_IGN); // Lift-R decides when to stop
+    if (lifts[self - 1].cpu >= 0)
+    {
+        pinSelf(lifts[self - 1].cpu);
+    }
+    procs[self - 1].cpu = sched_getcpu();
+    lift(&lifts[self - 1]);
+    procs[self - 1].endNs = profileNow();
+
+    // Report hot-path counters (only when compiled with PROFILE)
+    char title[32];
+    snprintf(title, sizeof(title), "Profile of process %d", (int)getpid());
+    PROF_DUMP(profiles, self, 1, title);
+
+    detachTrace(trace);
+    free(profiles);
+    shmdt(arena);
+
+    exit(0);
+}
+
+/* ****************************************************************************
+ * NAME:        liftDied
+ * 
+ * PURPOSE:     SIGCHLD handler for Lift-R. Flags the death and wakes Lift-R 
+ *              if it is waiting for room in the ring.
+ * 
+ * IMPORT:      sig - the signal number
+ * ***************************************************************************/
+void liftDied(int sig)
+{
+    liftExited = 1;
+    sem_post(&shm->empty);
+}
+
+/* ****************************************************************************
+ * NAME:        stopSim
+ * 
+ * PURPOSE:     SIGINT handler for Lift-R. Flags the interrupt for every 
+ *              process and wakes Lift-R if it is waiting for room in the 
+ *              ring, so it can close the ring.
+ * 
+ * IMPORT:      sig - the signal number
+ * ***************************************************************************/
+void stopSim(int sig)
+{
+    shm->interrupted = 1;
+    sem_post(&shm->empty);
+}
+
+/* ****************************************************************************
+ * NAME:        reapLifts
+ * 
+ * PURPOSE:     Collect lift processes that have exited. A lift that exited
+ *              cleanly is finished, any other has its request re-queued and
+ *              is started again.
+ * 
+ * IMPORT:      options - WNOHANG to only collect lifts that already exited,
+ *                        0 to wait until every lift has finished
+ * ***************************************************************************/
+void reapLifts(int options)
+{
+    int status = 0;
+    int done = 0;
+
+    liftExited = 0;
+    while (done == 0 && liftsRunning > 0)
+    {
+        pid_t pid = waitpid(-1, &status, options);
+        if (pid > 0)
+        {
+            int ii = 0;
+            while (ii < shm->numLifts && procs[ii].pid != pid)
             {
-                lift(lifts[0]); // Lift-1
+                ii++;
             }
-            else if (cpid2 > 0)
+
+            liftsRunning--;
+            if (ii < shm->numLifts && 
+                (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
             {
-                cpid3 = fork();
-                if (cpid3 == 0)
-                {
-                    lift(lifts[1]); // Lift-2
-                }
-                else if (cpid3 > 0)
-                {
-                    lift(lifts[2]); // Lift-3
-                }
+                recoverLift(ii);
+                spawnLift(ii);
             }
         }
-        else if (cpid1 > 0) // The parent is lift-R (this process)
+        else if (pid == 0 || errno != EINTR)
         {
-            request(requests);
-
-            // Wait for all children to finish up before closing
-            int status = 0;
-            while ((wait(&status)) > 0);
+            done = 1;
         }
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        recoverLift
+ * 
+ * PURPOSE:     Clean up after a lift process that died. If it was serving a
+ *              request (taken out of the ring, so not in it any more) the 
+ *              request goes back in the ring for another lift. The log may 
+ *              then show the request being taken twice. A request the lift
+ *              already marked as served is never re-queued, even if the 
+ *              lift died before it went back to idle.
+ * 
+ * IMPORT:      ii - index of the lift
+ * ***************************************************************************/
+void recoverLift(int ii)
+{
+    ProcStats* proc = &procs[ii];
+    Request front;
+    int requeued = 0;
+
+    lockArena();
+    if (proc->state == LIFT_SERVING && 
+        proc->servedNum != proc->inFlight.num &&
+        (peekRing(ring, &front) == -1 || front.num != proc->inFlight.num))
+    {
+        requeued = pushRing(ring, &proc->inFlight) == 0;
+    }
+    proc->state = LIFT_IDLE;
+    proc->restarts++;
+    pthread_mutex_unlock(&shm->mutex);
 
-        // Free
-        for (int ii = 0; ii < NUM_LIFTS; ii++)
+    if (requeued)
+    {
+        printf("Lift-%d (pid %d) died, re-queued request %d\n", 
+               lifts[ii].id, (int)proc->pid, proc->inFlight.num);
+    }
+    else
+    {
+        printf("Lift-%d (pid %d) died\n", lifts[ii].id, (int)proc->pid);
+    }
+
+    // It may have taken a wake-up with it
+    sem_post(&shm->full);
+}
+
+/* ****************************************************************************
+ * NAME:        lockArena
+ * 
+ * PURPOSE:     Lock the shared mutex. If the last owner died holding it, 
+ *              finish the pop it may have left half done and carry on.
+ * ***************************************************************************/
+void lockArena(void)
+{
+    if (pthread_mutex_lock(&shm->mutex) == EOWNERDEAD)
+    {
+        repairRing(ring);
+        pthread_mutex_consistent(&shm->mutex);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        printProcStats
+ * 
+ * PURPOSE:     Print each lift process's requests served and throughput 
+ *              (requests per second of the process's lifetime).
+ * ***************************************************************************/
+void printProcStats(void)
+{
+    double elapsed = (profileNow() - shm->startNs) / 1e9;
+
+    for (int ii = 0; ii < shm->numLifts; ii++)
+    {
+        Lift* lift = &lifts[ii];
+        double secs = (procs[ii].endNs - shm->startNs) / 1e9;
+
+        printf("Lift-%d (pid %d, cpu %d): %d requests, %d movements, "
+               "%.3f s, %.1f req/s", lift->id, (int)procs[ii].pid, 
+               procs[ii].cpu, lift->numRequests, lift->numMovements, secs, 
+               secs > 0 ? lift->numRequests / secs : 0.0);
+        if (procs[ii].restarts > 0)
         {
-            free(lifts[ii]);
-        }  
-        free(lifts);
-        freeLinkedList(requests);
+            printf(", %d restarts", procs[ii].restarts);
+        }
+        printf("\n");
+    }
 
-        // Free semaphores
-        sem_destroy(&shm->mutex);
-        sem_destroy(&shm->empty);
-        sem_destroy(&shm->full);
-    }  
+    // Lifts that died count the request they were serving, so use the total 
+    // completed instead of adding the lifts up
+    int served = shm->numRequestsServed;
+
+    printf("All lifts: %d/%d requests, %.3f s, %.1f req/s\n", served, 
+           shm->totalRequests, elapsed, elapsed > 0 ? served / elapsed : 0.0);
+    printClassStats(summary);
 }
 
 /* ****************************************************************************
@@ -199,35 +579,74 @@ void startSim(int bufferSize, int liftDelay, char* filename)
  * 
  * PURPOSE:     Function for the Lift-R process.
  *              This process is responsible for loading requests from the list
- *              into the buffer. Mutual exclusion is achieved through semaphores
- *              to ensure the buffer is never accessed while other processes
- *              are in their critical sections.
+ *              into the ring, waiting on 'empty' while the ring holds buffer 
+ *              size requests. 'full' tells the lifts a request is waiting.
+ *              It also looks after any lift process that dies meanwhile.
+ *              Once there are no more requests (or it is interrupted) it 
+ *              closes the ring and wakes every lift once.
  * 
  * IMPORT       Linked List of requests.
  * ***************************************************************************/
 void* request(void* arg)
 {
     LinkedList* requests = (LinkedList*)arg;
-    LinkedList* requestsCopy = createLinkedList();
+    PROF_THREAD(prof, &profiles[0]);
+    TraceThread tt;
+    traceThreadInit(&tt, trace, 1, 0, "Lift-R");
     Request* thisReq = removeStart(requests);
 
     while (thisReq != NULL)
     {
-        sem_wait(&shm->empty); // CRITICAL SECTION START
-        sem_wait(&shm->mutex);
+        // Only Lift-R pushes, so the count can only be too high, never low
+        PROF_START(t);
+        traceBegin(&tt, "buffer full");
+        while (ringCount(ring) >= shm->bufferSize && !shm->interrupted)
+        {
+            sem_wait(&shm->empty);
+            if (liftExited)
+            {
+                reapLifts(WNOHANG);
+            }
+        }
+        traceEnd(&tt, "buffer full");
+        PROF_ADD(prof, notFullWait, t);
+        PROF_INC(prof, notFullWaits);
+
+        // Log before publishing, so the request always precedes the lift
+        // operation serving it in the output file
+        if (!shm->interrupted)
+        {
+            simOutput->echoRequest(thisReq);
+            simOutput->request(thisReq, &outFile);
+            traceInstant(&tt, "enqueue", thisReq->num);
+            thisReq->queuedNs = profileNow();
+            pushRing(ring, thisReq);
+            PROF_INC(prof, items);
+
+            sem_post(&shm->full); 
+        }
 
-        printf("NEW REQUEST: %d to %d\n", thisReq->start, thisReq->destination);
-        addToBuffer(shm->buffer, thisReq);
-        insertLast(requestsCopy, thisReq);
-        writeRequest(thisReq);
+        // The ring holds a copy, and once interrupted the rest stay in the
+        // list (freed with it)
+        free(thisReq);
+        thisReq = shm->interrupted ? NULL : removeStart(requests);
 
-        sem_post(&shm->full); 
-        sem_post(&shm->mutex); // CRITICAL SECTION END
+        if (liftExited)
+        {
+            reapLifts(WNOHANG);
+        }
+    }
 
-        thisReq = removeStart(requests);
+    // End of stream: every lift will find the ring closed once it's empty
+    lockArena();
+    shm->closed = 1;
+    pthread_mutex_unlock(&shm->mutex);
+    for (int ii = 0; ii < shm->numLifts; ii++)
+    {
+        sem_post(&shm->full);
     }
 
-    freeLinkedList(requestsCopy); // free requests
+    traceFlush(&tt);
 
     return 0;
 }
@@ -237,74 +656,135 @@ void* request(void* arg)
  * 
  * PURPOSE:     Function for the Lift-x process.
  *              This process is responsible for extracting requests from the 
- *              buffer and processing the lift's operation on the request. 
- *              Mutual exclusion is ensured through semaphores.
+ *              ring and processing the lift's operation on the request. 
+ *              The request is recorded as in flight before it leaves the 
+ *              ring, so it is never lost if the process dies. The lift 
+ *              exits once the ring is closed and empty, or after its 
+ *              current request if the sim is interrupted.
  * 
  * IMPORT       Lift struct - contains lift state
  * ***************************************************************************/
 void* lift(void* arg)
 {
     Lift* lift = (Lift*)arg;
-    Request* req;
+    ProcStats* proc = &procs[lift->id - 1];
+    PROF_THREAD(prof, &profiles[lift->id]);
+    char name[16];
+    TraceThread tt;
+    Request req;
+
+    snprintf(name, sizeof(name), "Lift-%d", lift->id);
+    traceThreadInit(&tt, trace, 1, lift->id, name);
+    lift->trace = &tt;
 
     int finished = 0;
     while (finished != 1)
     {
-        sem_wait(&shm->full); // CRITICAL SECTION START
-        sem_wait(&shm->mutex);
-
-        req = popBuffer(shm->buffer);
-        shm->numRequestsServed++;
-
-        // If this was the last request, exit loop
-        if (shm->numRequestsServed >= shm->totalRequests)
+        PROF_START(t);
+        traceBegin(&tt, "buffer empty");
+        while (sem_wait(&shm->full) == -1 && errno == EINTR);
+        traceEnd(&tt, "buffer empty");
+        PROF_ADD(prof, notEmptyWait, t);
+        PROF_INC(prof, notEmptyWaits);
+
+        // Copy the request out before removing it: whenever this process
+        // dies, the request is either still in the ring or in flight
+        int claimed = 0;
+        PROF_START(l);
+        lockArena();
+        PROF_ADD(prof, lockWait, l);
+        PROF_INC(prof, locks);
+        PROF_LAP(l);
+        if (shm->interrupted)
         {
             finished = 1;
-
-            // Release other lifts stuck waiting 
-            sem_post(&shm->full);
         }
-
-        // Write acitvity to log 
-        if (req != NULL)
+        else
         {
-            lift->numRequests++;
-            writeLiftActivity(lift, req);
+            proc->state = LIFT_CLAIMING;
+            if (peekRing(ring, &proc->inFlight) == 0)
+            {
+                // Write activity to log while the request still holds its
+                // slot, so the log never shows more queued than the buffer
+                // size (Lift-R only logs a request once there is room)
+                proc->state = LIFT_SERVING;
+                lift->numRequests++;
+                simOutput->activity(lift, &proc->inFlight, &outFile);
+                popRing(ring, &req);
+                claimed = 1;
+            }
+            else
+            {
+                proc->state = LIFT_IDLE;
+                finished = shm->closed;
+            }
         }
+        pthread_mutex_unlock(&shm->mutex);
+        PROF_ADD(prof, lockHeld, l);
 
-        sem_post(&shm->empty); 
-        sem_post(&shm->mutex); // CRITICAL SECTION END
-
-        // Serve
-        if (req != NULL)
+        if (claimed == 0 && finished == 0)
         {
-            if (lift->currFloor != req->start)
+            // Another lift got there first
+            PROF_INC(prof, nullPops);
+        }
+        else if (claimed == 1)
+        {
+            traceInstant(&tt, "dequeue", req.num);
+            long long waitNs = profileNow() - req.queuedNs;
+            sem_post(&shm->empty); 
+            PROF_INC(prof, items);
+
+            // Serve
+            int fromFloor = lift->currFloor;
+            if (lift->currFloor != req.start)
             {
-                move(lift, req->start);
+                move(lift, req.start);
             }
-            move(lift, req->destination);
+            move(lift, req.destination);
+
+            // Only now is the request done with. Marking it served is a
+            // single store, so a lift dying anywhere after it (even with the
+            // arena locked) never has the request served twice, at worst 
+            // missing from the counts
+            lockArena();
+            proc->servedNum = req.num;
+            shm->numRequestsServed++;
+            recordRequest(summary, lift->id - 1, fromFloor, &req, waitNs);
+            proc->state = LIFT_IDLE;
+            pthread_mutex_unlock(&shm->mutex);
         }
     }
 
+    traceFlush(&tt);
+    lift->trace = NULL;
+
     return 0;
 }
 
 /* ****************************************************************************
  * NAME:        move
  * 
- * PURPOSE:     Processes a lift operation.
+ * PURPOSE:     Processes a lift operation, taking as long as the travel 
+ *              model says the leg takes (or no time at all, in virtual time).
  * 
  * IMPORT       lift - the lift struct
  *              to - an Integer describing the destination floor
  * ***************************************************************************/
 void move(Lift* lift, int to)
 {
-    printf("lift %d: moving from %d to %d\n", 
-            lift->id, lift->currFloor, to);
+    int ms = legTimeMs(lift->travel, lift->delay, abs(lift->currFloor - to));
+
+    simOutput->echoMove(lift, to);
 
-    sleep(lift->delay);
+    traceMoveBegin(lift->trace, lift->currFloor, to);
+    if (lift->travel == NULL || lift->travel->virtualTime == 0)
+    {
+        sleepMs(ms);
+    }
+    traceEnd(lift->trace, "move");
 
     // Increment movements
+    lift->travelMs += ms;
     lift->numMovements += abs(lift->currFloor - to);
     lift->currFloor = to;
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+/* ****************************************************************************
+ * FILE:        lift_stats.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Client for the live metrics of a running simulation.
+ *
+ *              Usage: ./lift_stats <socket> <optional_interval_seconds>
+ *
+ *              Prints one snapshot from the socket given to 
+ *              "lift_sim_A ... --metrics <socket>", or with an interval,
+ *              keeps polling until the simulation ends.
+ *
+ * LAST MOD:    19/10/26 
+ * ***************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+int pollMetrics(const char* path);
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        printf("wrong args: format = ./lift_stats <socket> <optional_interval>\n");
+    }
+    else
+    {
+        int interval = (argc == 3) ? atoi(argv[2]) : 0;
+
+        int status = pollMetrics(argv[1]);
+        while (status == 0 && interval > 0)
+        {
+            sleep(interval);
+            printf("\n");
+            status = pollMetrics(argv[1]);
+        }
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        pollMetrics
+ * 
+ * PURPOSE:     Connect to the metrics socket and print the snapshot it sends.
+ * 
+ * IMPORT:      path - file name of the unix socket
+ * EXPORT:      Error code (-1 = the simulation isn't running)
+ * ***************************************************************************/
+int pollMetrics(const char* path)
+{
+    struct sockaddr_un addr;
+    char buf[1024];
+    int status = 0;
+    ssize_t len;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1)
+    {
+        perror("there was an error connecting to the simulation");
+        status = -1;
+    }
+    else
+    {
+        while ((len = read(fd, buf, sizeof(buf))) > 0)
+        {
+            fwrite(buf, 1, len, stdout);
+        }
+        fflush(stdout);
+    }
+
+    if (fd != -1)
+    {
+        close(fd);
+    }
+
+    return status;
+}
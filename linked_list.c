@@ -94,6 +94,37 @@ void insertLast(LinkedList* list, Request* req)
     list->size++;
 }
 
+/* ****************************************************************************
+ * NAME:        appendList
+ * 
+ * PURPOSE:     To move every node of one list onto the tail of another,
+ *              without copying. The source list is left empty.
+ * 
+ * IMPORT:      list (pointer to the list to append to),
+ *              other (pointer to the list to empty)
+ * ***************************************************************************/
+void appendList(LinkedList* list, LinkedList* other)
+{
+    if(other->size > 0)
+    {
+        if(list->size < 1)
+        {
+            list->head = other->head;
+        }
+        else
+        {
+            list->tail->next = other->head;
+        }
+
+        list->tail = other->tail;
+        list->size += other->size;
+
+        other->head = NULL;
+        other->tail = NULL;
+        other->size = 0;
+    }
+}
+
 /* ****************************************************************************
  * NAME:        printLinkedList
  * 
@@ -11,12 +11,20 @@
 #ifndef LL
 #define LL
 
-// Represents a request (floor to dest)
+// Priority classes, from 0 (normal traffic) up to the most urgent
+// (e.g. 1 = accessibility / VIP floors, 2 = fire service)
+#define NUM_PRIORITIES 3
+
+// Represents a request (floor to dest, inside a building)
+// priority = its class, queuedNs = when it was added to the buffer
 typedef struct Request
 {
     int num;
     int start;
     int destination;
+    int building;
+    int priority;
+    long long queuedNs;
 } Request;
 
 // A node in the list
@@ -40,5 +48,6 @@ typedef struct
 LinkedList* createLinkedList();
 Request* removeStart(LinkedList* list);
 void insertLast(LinkedList* list, Request* req);
+void appendList(LinkedList* list, LinkedList* other);
 void printLinkedList(LinkedList* list);
 void freeLinkedList(LinkedList* list);
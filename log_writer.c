@@ -0,0 +1,318 @@
+/* ****************************************************************************
+ * FILE:        log_writer.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Writes a log file in the background, for the batched output
+ *              (--output-backend batch). The thread logging an event 
+ *              reserves room in a preallocated page, renders the event 
+ *              straight into it and commits it; once a page is full it is
+ *              handed to the log's writer thread and the next page is used,
+ *              so formatting carries on while earlier pages are written. The
+ *              writer thread writes every page waiting in one writev(), so
+ *              a busy log costs one system call per few hundred kilobytes
+ *              rather than an open, write and close per event.
+ *
+ *              Only one thread may append to a log at a time: in A every 
+ *              request and lift event of a building is logged under the 
+ *              building's logLock, which is what keeps each log to a single 
+ *              appender.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "log_writer.h"
+
+static void handOver(LogWriter* log);
+static void* writePages(void* arg);
+static int writeAll(int fd, struct iovec* iov, int count);
+
+/* ****************************************************************************
+ * NAME:        openLog
+ *
+ * PURPOSE:     Open a log for appending and start its writer thread.
+ *
+ * IMPORT:      path - the log file (created if missing)
+ * EXPORT:      pointer to the log (NULL if it can't be opened)
+ * ***************************************************************************/
+LogWriter* openLog(const char* path)
+{
+    LogWriter* log = NULL;
+    int fd = open(path, O_WRONLY | O_APPEND | O_CREAT, 0644);
+
+    if (fd == -1)
+    {
+        perror("there was an error opening the file");
+    }
+    else
+    {
+        log = (LogWriter*)malloc(sizeof(LogWriter));
+        snprintf(log->path, OUT_NAME_LEN, "%s", path);
+        log->fd = fd;
+        for (int ii = 0; ii < LOG_PAGES; ii++)
+        {
+            log->pages[ii] = (char*)malloc(LOG_PAGE);
+            log->lens[ii] = 0;
+        }
+        log->used = 0;
+        log->bytes = 0;
+        log->filled = 0;
+        log->written = 0;
+        log->stop = 0;
+        log->error = 0;
+        pthread_mutex_init(&log->lock, NULL);
+        pthread_cond_init(&log->ready, NULL);
+        pthread_cond_init(&log->done, NULL);
+        pthread_create(&log->thread, NULL, writePages, log);
+    }
+
+    return log;
+}
+
+/* ****************************************************************************
+ * NAME:        reserveLog
+ *
+ * PURPOSE:     Make room for the next event in the current page, so it can
+ *              be rendered in place, moving on to the next page if there
+ *              isn't enough. Only waits if every page is still waiting to be
+ *              written. Nothing is logged until commitLog.
+ *
+ * IMPORT:      log - the log
+ *              room - the most the event can take (at most LOG_PAGE)
+ * EXPORT:      where to write the event (room bytes are free)
+ * ***************************************************************************/
+char* reserveLog(LogWriter* log, int room)
+{
+    if (log->used + room > LOG_PAGE)
+    {
+        handOver(log);
+    }
+
+    return log->pages[log->filled % LOG_PAGES] + log->used;
+}
+
+/* ****************************************************************************
+ * NAME:        commitLog
+ *
+ * PURPOSE:     Log the event written where reserveLog pointed.
+ *
+ * IMPORT:      log - the log
+ *              len - the event's length (at most the room reserved)
+ * EXPORT:      Error code (-1 = an earlier write failed)
+ * ***************************************************************************/
+int commitLog(LogWriter* log, int len)
+{
+    log->used += len;
+    log->bytes += len;
+
+    return __atomic_load_n(&log->error, __ATOMIC_RELAXED) ? -1 : 0;
+}
+
+/* ****************************************************************************
+ * NAME:        appendLog
+ *
+ * PURPOSE:     Append an event that is already rendered to the log.
+ *
+ * IMPORT:      log - the log
+ *              text - the event
+ *              len - its length (at most LOG_PAGE)
+ * EXPORT:      Error code (-1 = an earlier write failed)
+ * ***************************************************************************/
+int appendLog(LogWriter* log, const char* text, int len)
+{
+    memcpy(reserveLog(log, len), text, len);
+
+    return commitLog(log, len);
+}
+
+/* ****************************************************************************
+ * NAME:        flushLog
+ *
+ * PURPOSE:     Hand over the current page and wait until everything
+ *              appended so far is in the file.
+ *
+ * IMPORT:      log - the log
+ * EXPORT:      Error code (-1 = a write failed)
+ * ***************************************************************************/
+int flushLog(LogWriter* log)
+{
+    if (log->used > 0)
+    {
+        handOver(log);
+    }
+
+    pthread_mutex_lock(&log->lock);
+    while (log->written != log->filled)
+    {
+        pthread_cond_wait(&log->done, &log->lock);
+    }
+    int status = log->error ? -1 : 0;
+    pthread_mutex_unlock(&log->lock);
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        closeLog
+ *
+ * PURPOSE:     Flush the log, stop its writer thread and free it.
+ *
+ * IMPORT:      log - the log
+ * EXPORT:      Error code (-1 = a write failed)
+ * ***************************************************************************/
+int closeLog(LogWriter* log)
+{
+    int status = flushLog(log);
+
+    pthread_mutex_lock(&log->lock);
+    log->stop = 1;
+    pthread_cond_signal(&log->ready);
+    pthread_mutex_unlock(&log->lock);
+    pthread_join(log->thread, NULL);
+
+    if (close(log->fd) == -1)
+    {
+        perror("there was an error closing the file");
+        status = -1;
+    }
+
+    for (int ii = 0; ii < LOG_PAGES; ii++)
+    {
+        free(log->pages[ii]);
+    }
+    pthread_mutex_destroy(&log->lock);
+    pthread_cond_destroy(&log->ready);
+    pthread_cond_destroy(&log->done);
+    free(log);
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        handOver
+ *
+ * PURPOSE:     Give the current page to the writer thread and move on to the
+ *              next one, waiting for it to be written if it hasn't been.
+ *
+ * IMPORT:      log - the log
+ * ***************************************************************************/
+static void handOver(LogWriter* log)
+{
+    pthread_mutex_lock(&log->lock);
+    log->lens[log->filled % LOG_PAGES] = log->used;
+    log->filled++;
+    pthread_cond_signal(&log->ready);
+
+    while (log->filled - log->written >= LOG_PAGES)
+    {
+        pthread_cond_wait(&log->done, &log->lock);
+    }
+    pthread_mutex_unlock(&log->lock);
+
+    log->used = 0;
+}
+
+/* ****************************************************************************
+ * NAME:        writePages
+ *
+ * PURPOSE:     Thread body: write every page handed over, as many as are
+ *              waiting at once, until told to stop.
+ *
+ * IMPORT:      Pointer to the log
+ * ***************************************************************************/
+static void* writePages(void* arg)
+{
+    LogWriter* log = (LogWriter*)arg;
+    struct iovec iov[LOG_PAGES];
+    int finished = 0;
+
+    pthread_mutex_lock(&log->lock);
+    while (finished != 1)
+    {
+        while (log->written == log->filled && log->stop == 0)
+        {
+            pthread_cond_wait(&log->ready, &log->lock);
+        }
+
+        if (log->written == log->filled)
+        {
+            finished = 1;
+        }
+        else
+        {
+            // The pages up to filled are the writer's until written moves
+            unsigned int first = log->written, last = log->filled;
+            pthread_mutex_unlock(&log->lock);
+
+            int count = 0;
+            for (unsigned int ii = first; ii != last; ii++)
+            {
+                iov[count].iov_base = log->pages[ii % LOG_PAGES];
+                iov[count].iov_len = log->lens[ii % LOG_PAGES];
+                count++;
+            }
+            int status = writeAll(log->fd, iov, count);
+
+            pthread_mutex_lock(&log->lock);
+            if (status == -1)
+            {
+                __atomic_store_n(&log->error, 1, __ATOMIC_RELAXED);
+            }
+            log->written = last;
+            pthread_cond_broadcast(&log->done);
+        }
+    }
+    pthread_mutex_unlock(&log->lock);
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        writeAll
+ *
+ * PURPOSE:     writev() the pages, carrying on after a short write.
+ *
+ * IMPORT:      fd - the file
+ *              iov - the pages (changed as they are written)
+ *              count - number of pages
+ * EXPORT:      Error code (-1 = the write failed)
+ * ***************************************************************************/
+static int writeAll(int fd, struct iovec* iov, int count)
+{
+    int status = 0;
+
+    while (count > 0 && status == 0)
+    {
+        ssize_t done = writev(fd, iov, count);
+        if (done == -1 && errno != EINTR)
+        {
+            perror("there was an error writing the file");
+            status = -1;
+        }
+
+        while (done > 0 && count > 0)
+        {
+            if ((size_t)done >= iov->iov_len)
+            {
+                done -= iov->iov_len;
+                iov++;
+                count--;
+            }
+            else
+            {
+                iov->iov_base = (char*)iov->iov_base + done;
+                iov->iov_len -= done;
+                done = 0;
+            }
+        }
+    }
+
+    return status;
+}
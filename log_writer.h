@@ -0,0 +1,52 @@
+/* ****************************************************************************
+ * FILE:        log_writer.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Header file for log_writer.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <pthread.h>
+#include "fileio.h"
+
+#ifndef LOG_WRITER
+#define LOG_WRITER
+
+#define LOG_PAGE (64 * 1024) // bytes
+#define LOG_PAGES 8
+
+// A log file written in the background. Events are rendered into the current
+// page of a ring of preallocated pages; full pages are handed to a writer
+// thread, which writes every page waiting with one writev().
+// filled = pages ever handed over, written = pages ever written (both only
+// count up, a page's slot is its count % LOG_PAGES)
+// used = bytes in the current page (only touched by the appending thread)
+// bytes = bytes appended so far, error = a write failed
+typedef struct LogWriter
+{
+    char path[OUT_NAME_LEN];
+    int fd;
+    char* pages[LOG_PAGES];
+    int lens[LOG_PAGES];
+    int used;
+    long long bytes;
+    unsigned int filled;
+    unsigned int written;
+    int stop;
+    int error;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_cond_t done;
+    pthread_t thread;
+} LogWriter;
+
+#endif
+
+// Prototype Declarations
+LogWriter* openLog(const char* path);
+char* reserveLog(LogWriter* log, int room);
+int commitLog(LogWriter* log, int len);
+int appendLog(LogWriter* log, const char* text, int len);
+int flushLog(LogWriter* log);
+int closeLog(LogWriter* log);
@@ -0,0 +1,223 @@
+/* ****************************************************************************
+ * FILE:        metrics.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Serves live metrics of a running simulation over a unix 
+ *              domain socket. Every client that connects is sent one text 
+ *              snapshot and disconnected (see lift_stats.c for a client).
+ *
+ *              Snapshots are taken without bufLock: every counter read here
+ *              is written by the sim with a relaxed atomic store (each has
+ *              one writer at a time, see lift_sim_A.c) and read with a 
+ *              relaxed atomic load. Both compile to plain moves on x86, so
+ *              the sim pays nothing for them. The counters are read one at
+ *              a time, so a snapshot may be a request or two out of step 
+ *              between them (e.g. a lift's floor and its movements).
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "metrics.h"
+#include "profile.h"
+
+#define LOAD(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+
+static void* serveMetrics(void* arg);
+static int campusServed(MetricsServer* server);
+
+/* ****************************************************************************
+ * NAME:        startMetrics
+ * 
+ * PURPOSE:     Create the socket and start the thread serving it.
+ * 
+ * IMPORT:      path - file name of the unix socket
+ *              buildings - array of buildings to report on
+ *              numBuildings - length of the array
+ * EXPORT:      pointer to the server (NULL = the socket couldn't be created)
+ * ***************************************************************************/
+MetricsServer* startMetrics(const char* path, Building** buildings, 
+                            int numBuildings)
+{
+    MetricsServer* server = NULL;
+    struct sockaddr_un addr;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    unlink(addr.sun_path); // left over from a previous run
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1 || 
+        bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 ||
+        listen(fd, 8) == -1)
+    {
+        perror("there was an error creating the metrics socket");
+        if (fd != -1)
+        {
+            close(fd);
+        }
+    }
+    else
+    {
+        server = (MetricsServer*)malloc(sizeof(MetricsServer));
+        snprintf(server->path, sizeof(server->path), "%s", addr.sun_path);
+        server->fd = fd;
+        server->stop = 0;
+        server->buildings = buildings;
+        server->numBuildings = numBuildings;
+        server->startNs = profileNow();
+        server->numSamples = 0;
+        pthread_create(&server->thread, NULL, serveMetrics, server);
+    }
+
+    return server;
+}
+
+/* ****************************************************************************
+ * NAME:        stopMetrics
+ * 
+ * PURPOSE:     Stop the server thread, remove the socket and free the server.
+ * 
+ * IMPORT:      Pointer to the server (may be NULL)
+ * ***************************************************************************/
+void stopMetrics(MetricsServer* server)
+{
+    if (server != NULL)
+    {
+        __atomic_store_n(&server->stop, 1, __ATOMIC_RELAXED);
+        pthread_join(server->thread, NULL);
+
+        close(server->fd);
+        unlink(server->path);
+        free(server);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        renderMetrics
+ * 
+ * PURPOSE:     Write a text snapshot of every building into a string.
+ * 
+ * IMPORT:      server - the server
+ *              out - string to write into
+ *              size - size of the string
+ * EXPORT:      Length of the snapshot
+ * ***************************************************************************/
+int renderMetrics(MetricsServer* server, char* out, int size)
+{
+    int len = 0;
+    double elapsed = (profileNow() - server->startNs) / 1e9;
+    int served = campusServed(server);
+
+    // Recent = since the oldest sample still in the window
+    double recent = 0.0;
+    int window = server->numSamples < METRICS_WINDOW ? server->numSamples 
+                                                     : METRICS_WINDOW;
+    if (window > 0)
+    {
+        long long oldest = server->samples[(server->numSamples - window) % 
+                                           METRICS_WINDOW];
+        recent = (served - oldest) / (double)window;
+    }
+
+    len += snprintf(out + len, size - len, 
+                    "elapsed %.1f s, throughput %.2f req/s (last %d s), "
+                    "%.2f req/s (overall)\n", elapsed, recent, window, 
+                    elapsed > 0 ? served / elapsed : 0.0);
+
+    for (int ii = 0; ii < server->numBuildings && len < size; ii++)
+    {
+        Building* building = server->buildings[ii];
+        int pushed = LOAD(building->numRequestsPushed);
+        int done = LOAD(building->numRequestsServed);
+
+        if (building->totalRequests > 0)
+        {
+            len += snprintf(out + len, size - len,
+                            "building %d: buffer %d/%d, served %d/%d\n",
+                            building->id, pushed - done, 
+                            building->buffer->capacity, done, 
+                            building->totalRequests);
+
+            for (int jj = 0; jj < building->numLifts && len < size; jj++)
+            {
+                Lift* lift = &building->lifts[jj];
+                len += snprintf(out + len, size - len,
+                                "    lift %d: floor %d, requests %d, "
+                                "movements %d\n", lift->id, 
+                                LOAD(lift->currFloor), LOAD(lift->numRequests),
+                                LOAD(lift->numMovements));
+            }
+        }
+    }
+
+    return len < size ? len : size - 1;
+}
+
+/* ****************************************************************************
+ * NAME:        serveMetrics
+ * 
+ * PURPOSE:     Thread body: sample throughput once a second and answer 
+ *              every client with a snapshot, until told to stop.
+ * 
+ * IMPORT:      Pointer to the server
+ * ***************************************************************************/
+static void* serveMetrics(void* arg)
+{
+    MetricsServer* server = (MetricsServer*)arg;
+    struct pollfd pfd = { server->fd, POLLIN, 0 };
+    long long nextSample = profileNow();
+    char reply[METRICS_REPLY];
+
+    while (LOAD(server->stop) == 0)
+    {
+        if (profileNow() >= nextSample)
+        {
+            server->samples[server->numSamples % METRICS_WINDOW] = 
+                campusServed(server);
+            server->numSamples++;
+            nextSample += 1000000000LL;
+        }
+
+        // Wake up regularly to notice stop requests and take samples
+        if (poll(&pfd, 1, 100) > 0)
+        {
+            int client = accept(server->fd, NULL, NULL);
+            if (client != -1)
+            {
+                int len = renderMetrics(server, reply, METRICS_REPLY);
+                if (send(client, reply, len, MSG_NOSIGNAL) != len)
+                {
+                    perror("there was an error writing metrics");
+                }
+                close(client);
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        campusServed
+ * 
+ * PURPOSE:     Returns the number of requests served in every building.
+ * ***************************************************************************/
+static int campusServed(MetricsServer* server)
+{
+    int served = 0;
+    for (int ii = 0; ii < server->numBuildings; ii++)
+    {
+        served += LOAD(server->buildings[ii]->numRequestsServed);
+    }
+
+    return served;
+}
@@ -0,0 +1,41 @@
+/* ****************************************************************************
+ * FILE:        metrics.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for metrics.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <pthread.h>
+#include "building.h"
+
+#ifndef METRICS
+#define METRICS
+
+// Seconds of history used for the "recent" throughput
+#define METRICS_WINDOW 10
+#define METRICS_REPLY 4096
+
+// The live metrics server. samples[] holds requests served (campus-wide) 
+// once a second, the oldest being overwritten first.
+typedef struct MetricsServer
+{
+    char path[108];
+    int fd;
+    int stop;
+    Building** buildings;
+    int numBuildings;
+    long long startNs;
+    long long samples[METRICS_WINDOW];
+    int numSamples;
+    pthread_t thread;
+} MetricsServer;
+
+#endif
+
+// Prototype Declarations
+MetricsServer* startMetrics(const char* path, Building** buildings, 
+                            int numBuildings);
+void stopMetrics(MetricsServer* server);
+int renderMetrics(MetricsServer* server, char* out, int size);
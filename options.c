@@ -0,0 +1,322 @@
+/* ****************************************************************************
+ * FILE:        options.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Parses the command line shared by implementations A and B:
+ *              the positional buffer size, lift delay and optional input 
+ *              file, plus any "--name value" flags in between.
+ *
+ * LAST MOD:    19/10/26 
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "options.h"
+#include "lift_sim.h"
+#include "buffer.h"
+#include "travel.h"
+#include "summary.h"
+#include "topology.h"
+
+/* ****************************************************************************
+ * NAME:        parseOptions
+ * 
+ * PURPOSE:     Fill in an options struct from the command line, printing 
+ *              the reason if the command line is invalid.
+ * 
+ * IMPORT:      argc, argv - the command line
+ *              opts - struct to fill in
+ * EXPORT:      Error code (-1 = invalid command line)
+ * ***************************************************************************/
+int parseOptions(int argc, char *argv[], Options* opts)
+{
+    char* positional[3];
+    int numPositional = 0, status = 0;
+
+    opts->filename = SIM_INPUT;
+    opts->numLifts = NUM_LIFTS;
+    opts->numProducers = NUM_PRODUCERS;
+    opts->pin = 0;
+    opts->cpuList = NULL;
+    opts->metricsPath = NULL;
+    opts->tracePath = NULL;
+    opts->summaryPath = NULL;
+    opts->outputMode = OUTPUT_PROSE;
+    opts->quiet = 0;
+    opts->outputBackend = BACKEND_STDIO;
+    opts->dispatch = DISPATCH_FIFO;
+    opts->analyzePath = NULL;
+    opts->solvePath = NULL;
+    opts->liftDelay = 0;
+    opts->checkpointPath = NULL;
+    opts->resume = 0;
+    opts->travel.floorMs = 0;
+    opts->travel.accelMs = 0;
+    opts->travel.doorMs = 0;
+    opts->travel.virtualTime = 0;
+
+    for (int ii = 1; ii < argc && status == 0; ii++)
+    {
+        if (strncmp(argv[ii], "--", 2) != 0)
+        {
+            if (numPositional < 3)
+            {
+                positional[numPositional] = argv[ii];
+            }
+            numPositional++;
+        }
+        else if (strcmp(argv[ii], "--virtual") == 0)
+        {
+            opts->travel.virtualTime = 1;
+        }
+        else if (strcmp(argv[ii], "--pin") == 0)
+        {
+            opts->pin = 1;
+        }
+        else if (strcmp(argv[ii], "--quiet") == 0)
+        {
+            opts->quiet = 1;
+        }
+        else if (strcmp(argv[ii], "--resume") == 0)
+        {
+            opts->resume = 1;
+        }
+        else if (ii + 1 >= argc)
+        {
+            printf("wrong args: %s expects a value\n", argv[ii]);
+            status = -1;
+        }
+        else if (strcmp(argv[ii], "--lifts") == 0)
+        {
+            opts->numLifts = atoi(argv[++ii]);
+            if (opts->numLifts < 1 || opts->numLifts > MAX_LIFTS)
+            {
+                printf("wrong args: --lifts expects 1 to %d\n", MAX_LIFTS);
+                status = -1;
+            }
+        }
+        else if (strcmp(argv[ii], "--producers") == 0)
+        {
+            opts->numProducers = atoi(argv[++ii]);
+            if (opts->numProducers < 1 || opts->numProducers > MAX_PRODUCERS)
+            {
+                printf("wrong args: --producers expects 1 to %d\n", 
+                       MAX_PRODUCERS);
+                status = -1;
+            }
+        }
+        else if (strcmp(argv[ii], "--cpus") == 0)
+        {
+            int cpus[MAX_CPUS];
+            opts->cpuList = argv[++ii];
+            opts->pin = 1;
+            if (parseCpuList(opts->cpuList, cpus, MAX_CPUS) == -1)
+            {
+                printf("wrong args: --cpus expects a list like 0,2,4-7\n");
+                status = -1;
+            }
+        }
+        else if (strcmp(argv[ii], "--metrics") == 0)
+        {
+            opts->metricsPath = argv[++ii];
+        }
+        else if (strcmp(argv[ii], "--trace") == 0)
+        {
+            opts->tracePath = argv[++ii];
+        }
+        else if (strcmp(argv[ii], "--output") == 0)
+        {
+            opts->outputMode = parseOutputMode(argv[++ii]);
+            if (opts->outputMode == -1)
+            {
+                printf("wrong args: --output expects prose, csv, summary "
+                       "or none\n");
+                status = -1;
+            }
+        }
+        else if (strcmp(argv[ii], "--output-backend") == 0)
+        {
+            opts->outputBackend = parseOutputBackend(argv[++ii]);
+            if (opts->outputBackend == -1)
+            {
+                printf("wrong args: --output-backend expects stdio or "
+                       "batch\n");
+                status = -1;
+            }
+        }
+        else if (strcmp(argv[ii], "--dispatch") == 0)
+        {
+            opts->dispatch = parseDispatch(argv[++ii]);
+            if (opts->dispatch == -1)
+            {
+                printf("wrong args: --dispatch expects fifo or nearest\n");
+                status = -1;
+            }
+        }
+        else if (strcmp(argv[ii], "--analyze") == 0)
+        {
+            opts->analyzePath = argv[++ii];
+        }
+        else if (strcmp(argv[ii], "--solve") == 0)
+        {
+            opts->solvePath = argv[++ii];
+        }
+        else if (strcmp(argv[ii], "--summary") == 0)
+        {
+            opts->summaryPath = argv[++ii];
+        }
+        else if (strcmp(argv[ii], "--checkpoint") == 0)
+        {
+            opts->checkpointPath = argv[++ii];
+        }
+        else if (strcmp(argv[ii], "--travel") == 0)
+        {
+            if (parseTravelModel(argv[++ii], &opts->travel) == -1)
+            {
+                printf("wrong args: --travel expects <floor,accel,door> ms\n");
+                status = -1;
+            }
+        }
+        else
+        {
+            printf("wrong args: unknown option %s\n", argv[ii]);
+            status = -1;
+        }
+    }
+
+    // Summary only output is pointless without the summary
+    if (opts->outputMode == OUTPUT_SUMMARY && opts->summaryPath == NULL)
+    {
+        opts->summaryPath = SUMMARY_FILE;
+    }
+
+    if (status == 0 && opts->resume == 1 && opts->checkpointPath == NULL)
+    {
+        printf("wrong args: --resume needs --checkpoint <file>\n");
+        status = -1;
+    }
+    else if (status == 0 && opts->checkpointPath != NULL && 
+             opts->numProducers > 1)
+    {
+        // A checkpoint only records how far one stream has got
+        printf("wrong args: --checkpoint needs a single producer\n");
+        status = -1;
+    }
+    else if (status == 0 && (opts->analyzePath != NULL || 
+                             opts->solvePath != NULL) && numPositional == 0)
+    {
+        // Nothing else is needed to report on a trace
+    }
+    else if (status == 0 && (numPositional < 2 || numPositional > 3))
+    {
+        printf("wrong args: format = %s\n", SYNTAX);
+        status = -1;
+    }
+    else if (status == 0)
+    {
+        // The lift delay is given in (possibly fractional) seconds
+        double delaySecs = atof(positional[1]);
+        opts->bufferSize = atoi(positional[0]);
+        opts->liftDelay = (int)(delaySecs * 1000.0 + 0.5);
+        if (numPositional == 3)
+        {
+            opts->filename = positional[2];
+        }
+
+        if (opts->bufferSize <= 0 || delaySecs < 0)
+        {
+            printf("Error: %s\n", ERR);
+            status = -1;
+        }
+        else if (opts->bufferSize > BUFFER_MAX_SIZE)
+        {
+            printf("Error: buffer should be at most %d\n", BUFFER_MAX_SIZE);
+            status = -1;
+        }
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        parseOutputMode
+ * 
+ * PURPOSE:     Convert the name of an output mode to its OUTPUT_ constant.
+ * 
+ * IMPORT:      str - prose, csv, summary or none
+ * EXPORT:      The mode (-1 = unknown)
+ * ***************************************************************************/
+int parseOutputMode(const char* str)
+{
+    int mode = -1;
+
+    if (strcmp(str, "prose") == 0)
+    {
+        mode = OUTPUT_PROSE;
+    }
+    else if (strcmp(str, "csv") == 0)
+    {
+        mode = OUTPUT_CSV;
+    }
+    else if (strcmp(str, "summary") == 0)
+    {
+        mode = OUTPUT_SUMMARY;
+    }
+    else if (strcmp(str, "none") == 0)
+    {
+        mode = OUTPUT_NONE;
+    }
+
+    return mode;
+}
+
+/* ****************************************************************************
+ * NAME:        parseOutputBackend
+ * 
+ * PURPOSE:     Convert the name of an output backend to its BACKEND_ 
+ *              constant.
+ * 
+ * IMPORT:      str - stdio or batch
+ * EXPORT:      The backend (-1 = unknown)
+ * ***************************************************************************/
+int parseOutputBackend(const char* str)
+{
+    int backend = -1;
+
+    if (strcmp(str, "stdio") == 0)
+    {
+        backend = BACKEND_STDIO;
+    }
+    else if (strcmp(str, "batch") == 0)
+    {
+        backend = BACKEND_BATCH;
+    }
+
+    return backend;
+}
+
+/* ****************************************************************************
+ * NAME:        parseDispatch
+ * 
+ * PURPOSE:     Convert the name of a dispatch policy to its DISPATCH_ 
+ *              constant.
+ * 
+ * IMPORT:      str - fifo or nearest
+ * EXPORT:      The policy (-1 = unknown)
+ * ***************************************************************************/
+int parseDispatch(const char* str)
+{
+    int dispatch = -1;
+
+    if (strcmp(str, "fifo") == 0)
+    {
+        dispatch = DISPATCH_FIFO;
+    }
+    else if (strcmp(str, "nearest") == 0)
+    {
+        dispatch = DISPATCH_NEAREST;
+    }
+
+    return dispatch;
+}
@@ -0,0 +1,75 @@
+/* ****************************************************************************
+ * FILE:        options.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for options.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+
+#ifndef OPTIONS
+#define OPTIONS
+
+#include "travel.h"
+
+// What the output file gets (see output.c)
+#define OUTPUT_PROSE 0
+#define OUTPUT_CSV 1
+#define OUTPUT_SUMMARY 2 // no output file, only the summary
+#define OUTPUT_NONE 3
+
+// How the output file is written (see output.c)
+#define BACKEND_STDIO 0
+#define BACKEND_BATCH 1 // formatted into pages written in the background (A)
+
+// How a lift picks its next request (see priority_buffer.c)
+#define DISPATCH_FIFO 0
+#define DISPATCH_NEAREST 1 // normal traffic by floor, nearest call first (A)
+
+// Everything the command line can configure
+// metricsPath = unix socket to serve live metrics on (NULL = off)
+// tracePath = Chrome trace-event JSON file to write (NULL = off)
+// summaryPath = per-lift and per-floor totals to write at the end (NULL = off)
+// outputMode = OUTPUT_xxx, quiet = don't trace every event to stdout
+// outputBackend = BACKEND_xxx, dispatch = DISPATCH_xxx
+// analyzePath = only report on this trace, don't simulate (NULL = simulate)
+// solvePath = only compare the simulated policy on this trace to the best
+// possible schedules, don't simulate (NULL = simulate)
+// liftDelay = fixed delay of every lift operation, in milliseconds
+// numLifts = lifts per building, numProducers = request threads per 
+// building, each adding the requests of its own stream (A), pin = pin the
+// producer and every lift to a CPU of cpuList (NULL = every CPU the process
+// may use), see topology.c
+// checkpointPath = file to checkpoint the sim to (NULL = off), resume = 
+// carry on from that checkpoint instead of starting again (A)
+typedef struct Options
+{
+    int bufferSize;
+    int liftDelay;
+    int numLifts;
+    int numProducers;
+    int pin;
+    char* cpuList;
+    char* filename;
+    char* metricsPath;
+    char* tracePath;
+    char* summaryPath;
+    int outputMode;
+    int quiet;
+    int outputBackend;
+    int dispatch;
+    char* analyzePath;
+    char* solvePath;
+    char* checkpointPath;
+    int resume;
+    TravelModel travel;
+} Options;
+
+#endif
+
+// Prototype Declarations
+int parseOptions(int argc, char *argv[], Options* opts);
+int parseOutputMode(const char* str);
+int parseOutputBackend(const char* str);
+int parseDispatch(const char* str);
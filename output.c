@@ -0,0 +1,304 @@
+/* ****************************************************************************
+ * FILE:        output.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     The ways the sim can report what happens: the original prose
+ *              log (see fileio.c), one CSV row per event, or nothing at all 
+ *              (when only the summary is wanted), with or without tracing 
+ *              every event to stdout.
+ *
+ *              The prose and CSV logs are written either through stdio, 
+ *              opening and closing the file for every event, or batched 
+ *              (--output-backend batch): each event is rendered in place 
+ *              into the current page of the file's LogWriter, which writes
+ *              the pages in the background (see log_writer.c).
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "output.h"
+#include "fileio.h"
+#include "log_writer.h"
+#include "render.h"
+
+static int writeRequestProse(Request* req, OutFile* out);
+static int writeLiftActivityProse(Lift* lift, Request* req, OutFile* out);
+static int beginNothing(OutFile* out);
+static int writeNothing(Request* req, OutFile* out);
+static int writeNoActivity(Lift* lift, Request* req, OutFile* out);
+static int openBatch(OutFile* out);
+static int flushBatch(OutFile* out);
+static int closeBatch(OutFile* out);
+static int writeRequestBatch(Request* req, OutFile* out);
+static int writeLiftActivityBatch(Lift* lift, Request* req, OutFile* out);
+static void echoRequest(Request* req);
+static void echoMove(Lift* lift, int to);
+static void echoNoRequest(Request* req);
+static void echoNoMove(Lift* lift, int to);
+
+static Output chosen = { beginNothing, beginNothing, beginNothing, 
+                         beginNothing, writeRequestProse, 
+                         writeLiftActivityProse, 
+                         echoRequest, echoMove };
+const Output* simOutput = &chosen;
+
+// How the batched output renders events
+static int (*renderReq)(char* out, Request* req) = renderRequest;
+static int (*renderAct)(char* out, Lift* lift, Request* req) = 
+    renderLiftActivity;
+
+/* ****************************************************************************
+ * NAME:        selectOutput
+ * 
+ * PURPOSE:     Choose how the sim reports events, for the rest of the run.
+ * 
+ * IMPORT:      mode - OUTPUT_PROSE, OUTPUT_CSV, OUTPUT_SUMMARY or OUTPUT_NONE
+ *              quiet - 1 to stop tracing every event to stdout
+ *              backend - BACKEND_STDIO or BACKEND_BATCH
+ * EXPORT:      the output chosen (also left in simOutput)
+ * ***************************************************************************/
+const Output* selectOutput(int mode, int quiet, int backend)
+{
+    chosen.open = beginNothing;
+    chosen.flush = beginNothing;
+    chosen.close = beginNothing;
+
+    if (mode == OUTPUT_CSV)
+    {
+        chosen.begin = beginCsv;
+        chosen.request = writeRequestCsv;
+        chosen.activity = writeLiftActivityCsv;
+        renderReq = renderRequestCsv;
+        renderAct = renderLiftActivityCsv;
+    }
+    else if (mode == OUTPUT_PROSE)
+    {
+        chosen.begin = beginNothing;
+        chosen.request = writeRequestProse;
+        chosen.activity = writeLiftActivityProse;
+        renderReq = renderRequest;
+        renderAct = renderLiftActivity;
+    }
+    else
+    {
+        chosen.begin = beginNothing;
+        chosen.request = writeNothing;
+        chosen.activity = writeNoActivity;
+    }
+
+    // Batch whatever is written to a file
+    if (backend == BACKEND_BATCH && 
+        (mode == OUTPUT_CSV || mode == OUTPUT_PROSE))
+    {
+        chosen.open = openBatch;
+        chosen.flush = flushBatch;
+        chosen.close = closeBatch;
+        chosen.request = writeRequestBatch;
+        chosen.activity = writeLiftActivityBatch;
+    }
+
+    chosen.echoRequest = (quiet == 1) ? echoNoRequest : echoRequest;
+    chosen.echoMove = (quiet == 1) ? echoNoMove : echoMove;
+
+    return simOutput;
+}
+
+/* ****************************************************************************
+ * NAME:        beginCsv
+ * 
+ * PURPOSE:     Start a CSV output file with its header.
+ * 
+ * IMPORT:      The output file
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int beginCsv(OutFile* out)
+{
+    int status = 0;
+
+    FILE* file = fopen(out->name, "w");
+    if (file == NULL)
+    {
+        perror("there was an error opening the file");
+        status = -1;
+    }
+    else
+    {
+        fputs(CSV_HEADER, file);
+        fclose(file);
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        writeRequestCsv
+ * 
+ * PURPOSE:     Append a request being added to the buffer as one CSV row.
+ * 
+ * IMPORT:      Pointer to a request
+ *              The output file
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int writeRequestCsv(Request* req, OutFile* out)
+{
+    char text[EVENT_LEN];
+    renderRequestCsv(text, req);
+
+    return appendText(text, out->name);
+}
+
+/* ****************************************************************************
+ * NAME:        writeLiftActivityCsv
+ * 
+ * PURPOSE:     Append a lift taking a request as one CSV row, with the same
+ *              details as the prose log.
+ * 
+ * IMPORT:      Pointer to the lift struct (before it moves)
+ *              Pointer to the request
+ *              The output file
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int writeLiftActivityCsv(Lift* lift, Request* req, OutFile* out)
+{
+    char text[EVENT_LEN];
+    renderLiftActivityCsv(text, lift, req);
+
+    return appendText(text, out->name);
+}
+
+/* ****************************************************************************
+ * NAME:        writeRequestProse, writeLiftActivityProse
+ * 
+ * PURPOSE:     Append an event to the prose log (see fileio.c).
+ * ***************************************************************************/
+static int writeRequestProse(Request* req, OutFile* out)
+{
+    return writeRequest(req, out->name);
+}
+
+static int writeLiftActivityProse(Lift* lift, Request* req, OutFile* out)
+{
+    return writeLiftActivity(lift, req, out->name);
+}
+
+/* ****************************************************************************
+ * NAME:        beginNothing, writeNothing, writeNoActivity
+ * 
+ * PURPOSE:     Log nothing (the prose log needs no header either, and stdio
+ *              needs nothing opened, flushed or closed).
+ * ***************************************************************************/
+static int beginNothing(OutFile* out)
+{
+    return 0;
+}
+
+static int writeNothing(Request* req, OutFile* out)
+{
+    return 0;
+}
+
+static int writeNoActivity(Lift* lift, Request* req, OutFile* out)
+{
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        openBatch
+ * 
+ * PURPOSE:     Start batching an output file's events (after begin), 
+ *              keeping its log with it.
+ * 
+ * IMPORT:      The output file
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+static int openBatch(OutFile* out)
+{
+    out->log = openLog(out->name);
+
+    return (out->log == NULL) ? -1 : 0;
+}
+
+/* ****************************************************************************
+ * NAME:        flushBatch
+ * 
+ * PURPOSE:     Wait until every event logged to an output file is in it 
+ *              (e.g. before its size is checkpointed).
+ * 
+ * IMPORT:      The output file
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+static int flushBatch(OutFile* out)
+{
+    return (out->log == NULL) ? 0 : flushLog(out->log);
+}
+
+/* ****************************************************************************
+ * NAME:        closeBatch
+ * 
+ * PURPOSE:     Write the rest of an output file's events and close it.
+ * 
+ * IMPORT:      The output file
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+static int closeBatch(OutFile* out)
+{
+    int status = 0;
+
+    if (out->log != NULL)
+    {
+        status = closeLog(out->log);
+        out->log = NULL;
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        writeRequestBatch, writeLiftActivityBatch
+ * 
+ * PURPOSE:     Render an event as the stdio output would, straight into 
+ *              its output file's current page, and add it to the batch.
+ * ***************************************************************************/
+static int writeRequestBatch(Request* req, OutFile* out)
+{
+    int len = renderReq(reserveLog(out->log, EVENT_LEN), req);
+
+    return commitLog(out->log, len);
+}
+
+static int writeLiftActivityBatch(Lift* lift, Request* req, OutFile* out)
+{
+    int len = renderAct(reserveLog(out->log, EVENT_LEN), lift, req);
+
+    return commitLog(out->log, len);
+}
+
+/* ****************************************************************************
+ * NAME:        echoRequest, echoMove
+ * 
+ * PURPOSE:     Trace a new request / lift movement to stdout.
+ * ***************************************************************************/
+static void echoRequest(Request* req)
+{
+    printf("NEW REQUEST: %d to %d\n", req->start, req->destination);
+}
+
+static void echoMove(Lift* lift, int to)
+{
+    printf("lift %d: moving from %d to %d\n", lift->id, lift->currFloor, to);
+}
+
+/* ****************************************************************************
+ * NAME:        echoNoRequest, echoNoMove
+ * 
+ * PURPOSE:     Trace nothing (--quiet).
+ * ***************************************************************************/
+static void echoNoRequest(Request* req)
+{
+}
+
+static void echoNoMove(Lift* lift, int to)
+{
+}
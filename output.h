@@ -0,0 +1,57 @@
+/* ****************************************************************************
+ * FILE:        output.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for output.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include "lift_sim.h"
+#include "linked_list.h"
+#include "fileio.h"
+#include "log_writer.h"
+
+#ifndef OUTPUT
+#define OUTPUT
+
+#define CSV_HEADER "event,request,lift,start,destination,previous_floor," \
+                   "movements,lift_requests,lift_movements\n"
+
+// An output file: its name, and its log while it is open for the batched
+// output (set by open, so logging an event never has to look it up)
+typedef struct OutFile
+{
+    char name[OUT_NAME_LEN];
+    LogWriter* log;
+} OutFile;
+
+// How the sim reports every event, chosen once before it starts (see 
+// selectOutput) so the lifts never check the configuration per event.
+// begin = start a fresh output file
+// open / close = start / stop logging to an output file (after begin), 
+// flush = make sure everything logged so far is in the file
+// request / activity = log a request being added / served to the file
+// echoRequest / echoMove = trace a request / lift movement to stdout
+typedef struct Output
+{
+    int (*begin)(OutFile* out);
+    int (*open)(OutFile* out);
+    int (*flush)(OutFile* out);
+    int (*close)(OutFile* out);
+    int (*request)(Request* req, OutFile* out);
+    int (*activity)(Lift* lift, Request* req, OutFile* out);
+    void (*echoRequest)(Request* req);
+    void (*echoMove)(Lift* lift, int to);
+} Output;
+
+#endif
+
+// The output in use (prose to the file and stdout until selectOutput)
+extern const Output* simOutput;
+
+// Prototype Declarations
+const Output* selectOutput(int mode, int quiet, int backend);
+int beginCsv(OutFile* out);
+int writeRequestCsv(Request* req, OutFile* out);
+int writeLiftActivityCsv(Lift* lift, Request* req, OutFile* out);
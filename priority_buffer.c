@@ -0,0 +1,332 @@
+/* ****************************************************************************
+ * FILE:        priority_buffer.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     A buffer that hands out the most urgent request first. Each
+ *              priority class has its own FIFO buffer, so adding and popping
+ *              stay O(1) (one look at each of the few classes), and requests
+ *              of the same class keep their order. A class passed over
+ *              PRIORITY_AGING times in a row goes next however urgent the
+ *              others are, so no class waits forever.
+ *
+ *              For --dispatch nearest, normal traffic (class 0) is held by 
+ *              floor and direction instead (see hall_calls.c), and a lift 
+ *              takes the nearest call ahead of it rather than the oldest.
+ *              Urgent classes stay first come, first served. Otherwise no 
+ *              index is kept at all, so FIFO dispatch doesn't pay for it.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "lift_sim.h"
+#include "priority_buffer.h"
+#include "buffer.h"
+#include "linked_list.h"
+#include "hall_calls.h"
+
+static Request* takeNearest(HallCalls* calls, int floor, int dir);
+
+/* ****************************************************************************
+ * NAME:        createPriorityBuffer
+ *
+ * PURPOSE:     To generate an empty priority buffer. Every class can take
+ *              the whole capacity, but all of them together can't exceed it.
+ *
+ * IMPORT:      size - capacity (>= 1)
+ *              byFloor - 1 to hold normal traffic by floor, for popNearest
+ * EXPORT:      pointer to the priority buffer (NULL if size is invalid, or 
+ *              a class buffer can't be created)
+ * ***************************************************************************/
+PriorityBuffer* createPriorityBuffer(int size, int byFloor)
+{
+    PriorityBuffer* pbuf = NULL;
+
+    if (size >= 1)
+    {
+        int created = 1;
+        pbuf = (PriorityBuffer*)malloc(sizeof(PriorityBuffer));
+        pbuf->size = 0;
+        pbuf->capacity = size;
+        pbuf->calls = byFloor ? createHallCalls(NUM_FLOORS) : NULL;
+        for (int ii = 0; ii < NUM_PRIORITIES; ii++)
+        {
+            pbuf->classes[ii] = createBuffer(size);
+            pbuf->counts[ii] = 0;
+            pbuf->skipped[ii] = 0;
+            if (pbuf->classes[ii] == NULL)
+            {
+                created = 0;
+            }
+        }
+
+        // Undo a partly created buffer
+        if (created == 0)
+        {
+            for (int ii = 0; ii < NUM_PRIORITIES; ii++)
+            {
+                if (pbuf->classes[ii] != NULL)
+                {
+                    freeBuffer(pbuf->classes[ii]);
+                }
+            }
+            if (pbuf->calls != NULL)
+            {
+                freeHallCalls(pbuf->calls);
+            }
+            free(pbuf);
+            pbuf = NULL;
+        }
+    }
+
+    return pbuf;
+}
+
+/* ****************************************************************************
+ * NAME:        popPriorityBuffer
+ *
+ * PURPOSE:     Remove and return the oldest request of the most urgent class
+ *              waiting, unless a class has been passed over too often. 
+ *              Normal traffic held by floor is taken as if for a lift on 
+ *              the ground floor going up.
+ *
+ * IMPORT:      Pointer to the priority buffer
+ * EXPORT:      Pointer to the request (NULL if empty)
+ * ***************************************************************************/
+Request* popPriorityBuffer(PriorityBuffer* pbuf)
+{
+    return popNearest(pbuf, GROUND_FLOOR, CALL_UP);
+}
+
+/* ****************************************************************************
+ * NAME:        popNearest
+ *
+ * PURPOSE:     popPriorityBuffer for a lift at a floor, going a direction: 
+ *              the class is picked the same way, but if it is normal traffic
+ *              held by floor, the lift gets the nearest call (see 
+ *              takeNearest). Without the index, the lift is ignored.
+ *
+ * IMPORT:      pbuf - the priority buffer
+ *              floor - the lift's floor
+ *              dir - its direction of travel (CALL_UP or CALL_DOWN)
+ * EXPORT:      Pointer to the request (NULL if empty)
+ * ***************************************************************************/
+Request* popNearest(PriorityBuffer* pbuf, int floor, int dir)
+{
+    Request* req = NULL;
+    int next = -1;
+
+    // An aged class first (the most urgent of them), else the most urgent
+    for (int ii = NUM_PRIORITIES - 1; ii >= 0 && next == -1; ii--)
+    {
+        if (pbuf->counts[ii] > 0 && pbuf->skipped[ii] >= PRIORITY_AGING)
+        {
+            next = ii;
+        }
+    }
+    for (int ii = NUM_PRIORITIES - 1; ii >= 0 && next == -1; ii--)
+    {
+        if (pbuf->counts[ii] > 0)
+        {
+            next = ii;
+        }
+    }
+
+    if (next != -1)
+    {
+        if (next == 0 && pbuf->calls != NULL)
+        {
+            req = takeNearest(pbuf->calls, floor, dir);
+        }
+        else
+        {
+            req = popBuffer(pbuf->classes[next]);
+        }
+        pbuf->counts[next]--;
+        pbuf->size--;
+
+        for (int ii = 0; ii < NUM_PRIORITIES; ii++)
+        {
+            if (ii == next || pbuf->counts[ii] == 0)
+            {
+                pbuf->skipped[ii] = 0;
+            }
+            else
+            {
+                pbuf->skipped[ii]++;
+            }
+        }
+    }
+
+    return req;
+}
+
+/* ****************************************************************************
+ * NAME:        addToPriorityBuffer
+ *
+ * PURPOSE:     Insert a request behind the others of its class. Requests of
+ *              an unknown class are treated as normal traffic.
+ *
+ * IMPORT:      Pointer to the priority buffer
+ *              Pointer to the request
+ * EXPORT:      Error code (-1 = buffer full, request not added)
+ * ***************************************************************************/
+int addToPriorityBuffer(PriorityBuffer* pbuf, Request* inReq)
+{
+    int status = -1;
+    int priority = inReq->priority;
+    if (priority < 0 || priority >= NUM_PRIORITIES)
+    {
+        priority = 0;
+    }
+
+    if (pbuf->size < pbuf->capacity) // Check for free slot
+    {
+        if (priority == 0 && pbuf->calls != NULL)
+        {
+            status = addCall(pbuf->calls, inReq);
+        }
+        else
+        {
+            status = addToBuffer(pbuf->classes[priority], inReq);
+        }
+
+        if (status == 0)
+        {
+            pbuf->counts[priority]++;
+            pbuf->size++;
+        }
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        isPriorityEmpty
+ *
+ * PURPOSE:     Returns 1 if no class has a request waiting.
+ *
+ * IMPORT:      Pointer to the priority buffer
+ * EXPORT:      Integer (1 = empty)
+ * ***************************************************************************/
+int isPriorityEmpty(PriorityBuffer* pbuf)
+{
+    return pbuf->size == 0;
+}
+
+/* ****************************************************************************
+ * NAME:        isPriorityFull
+ *
+ * PURPOSE:     Returns 1 if the classes together are at capacity.
+ *
+ * IMPORT:      Pointer to the priority buffer
+ * EXPORT:      Integer (1 = full)
+ * ***************************************************************************/
+int isPriorityFull(PriorityBuffer* pbuf)
+{
+    return pbuf->size >= pbuf->capacity;
+}
+
+/* ****************************************************************************
+ * NAME:        copyPriorityBuffer
+ *
+ * PURPOSE:     Copy out every waiting request without removing any, class
+ *              by class and oldest first within a class (normal traffic held
+ *              by floor goes last, floor by floor, oldest first on each), so 
+ *              adding them back in the same order rebuilds the buffer.
+ *
+ * IMPORT:      pbuf - the priority buffer
+ *              out - room for capacity requests
+ * EXPORT:      Number of requests copied
+ * ***************************************************************************/
+int copyPriorityBuffer(PriorityBuffer* pbuf, Request* out)
+{
+    int numCopied = 0;
+
+    for (int ii = 0; ii < NUM_PRIORITIES; ii++)
+    {
+        Buffer* buf = pbuf->classes[ii];
+        for (unsigned int jj = buf->next_out; jj != buf->next_in; jj++)
+        {
+            out[numCopied++] = *buf->buf[jj & buf->mask];
+        }
+    }
+
+    for (int dir = CALL_UP; pbuf->calls != NULL && dir <= CALL_DOWN; dir++)
+    {
+        for (int ii = 0; ii <= pbuf->calls->numFloors; ii++)
+        {
+            CallQueue* queue = &pbuf->calls->queues[dir][ii];
+            for (int jj = 0; jj < queue->count; jj++)
+            {
+                out[numCopied++] = 
+                    *queue->reqs[(queue->head + jj) & (queue->room - 1)];
+            }
+        }
+    }
+
+    return numCopied;
+}
+
+/* ****************************************************************************
+ * NAME:        freePriorityBuffer
+ *
+ * PURPOSE:     Free the priority buffer including all requests in it.
+ *
+ * IMPORT:      Pointer to the priority buffer
+ * ***************************************************************************/
+void freePriorityBuffer(PriorityBuffer* pbuf)
+{
+    for (int ii = 0; ii < NUM_PRIORITIES; ii++)
+    {
+        freeBuffer(pbuf->classes[ii]);
+    }
+
+    if (pbuf->calls != NULL)
+    {
+        while (pbuf->calls->size > 0)
+        {
+            free(takeNearest(pbuf->calls, GROUND_FLOOR, CALL_UP));
+        }
+        freeHallCalls(pbuf->calls);
+    }
+
+    free(pbuf);
+}
+
+/* ****************************************************************************
+ * NAME:        takeNearest
+ *
+ * PURPOSE:     Take the call a lift should serve next, sweeping the way a 
+ *              lift does: the nearest call ahead of it going its way, else 
+ *              the furthest call going the other way (it turns round there),
+ *              else the furthest call behind it going its way. Only the 
+ *              oldest call on a floor is taken. Far floors can wait a while
+ *              when busy floors keep calling.
+ *
+ * IMPORT:      calls - the index (not empty)
+ *              floor - the lift's floor
+ *              dir - its direction of travel
+ * EXPORT:      Pointer to the request
+ * ***************************************************************************/
+static Request* takeNearest(HallCalls* calls, int floor, int dir)
+{
+    int other = (dir == CALL_UP) ? CALL_DOWN : CALL_UP;
+    int end = (dir == CALL_UP) ? calls->numFloors : 0; // furthest ahead
+    int found = nearestCall(calls, floor, dir);
+    int takeDir = dir;
+
+    if (found == -1)
+    {
+        found = nearestCall(calls, end, other);
+        takeDir = other;
+    }
+    if (found == -1)
+    {
+        found = nearestCall(calls, calls->numFloors - end, dir);
+        takeDir = dir;
+    }
+
+    return takeCall(calls, found, takeDir);
+}
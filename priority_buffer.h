@@ -0,0 +1,47 @@
+/* ****************************************************************************
+ * FILE:        priority_buffer.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Header file for priority_buffer.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include "linked_list.h"
+#include "buffer.h"
+#include "hall_calls.h"
+
+#ifndef PRIORITY_BUFFER
+#define PRIORITY_BUFFER
+
+// A waiting class passed over this many times in a row is served next, so
+// urgent traffic can never starve normal traffic for long
+#define PRIORITY_AGING 4
+
+// A buffer serving the most urgent class first: one FIFO buffer per class,
+// sharing one capacity between them.
+// counts = requests waiting in each class, size = in all classes
+// skipped = times each class has been passed over since it was last served
+// calls = normal traffic by floor and direction instead of in classes[0], 
+// for lifts taking the nearest call (see popNearest), NULL if not wanted
+typedef struct PriorityBuffer
+{
+    Buffer* classes[NUM_PRIORITIES];
+    HallCalls* calls;
+    int counts[NUM_PRIORITIES];
+    int skipped[NUM_PRIORITIES];
+    int size;
+    int capacity;
+} PriorityBuffer;
+
+#endif
+
+// Prototype Declarations
+PriorityBuffer* createPriorityBuffer(int size, int byFloor);
+Request* popPriorityBuffer(PriorityBuffer* pbuf);
+Request* popNearest(PriorityBuffer* pbuf, int floor, int dir);
+int addToPriorityBuffer(PriorityBuffer* pbuf, Request* inReq);
+int isPriorityEmpty(PriorityBuffer* pbuf);
+int isPriorityFull(PriorityBuffer* pbuf);
+int copyPriorityBuffer(PriorityBuffer* pbuf, Request* out);
+void freePriorityBuffer(PriorityBuffer* pbuf);
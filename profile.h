@@ -0,0 +1,60 @@
+/* ****************************************************************************
+ * FILE:        profile.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for profile.c
+ *
+ *              Hot-path counters and timers, compiled in with "make PROFILE=1"
+ *              (which defines PROFILE). Without it every PROF_ macro expands
+ *              to nothing, so the sim pays nothing for them.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include "cache.h"
+
+#ifndef PROF
+#define PROF
+
+// Per-thread counters, one cache line (or more) each so threads never share.
+// xxxNs = nanoseconds spent, xxxWaits = number of times it happened.
+// lockWait = waiting to acquire the buffer lock, lockHeld = time holding it
+// (not counting condition/semaphore waits), notFull / notEmpty = waiting for
+// the buffer to have room / have requests.
+typedef struct Profile
+{
+    long long locks;
+    long long lockWaitNs;
+    long long lockHeldNs;
+    long long notFullWaits;
+    long long notFullWaitNs;
+    long long notEmptyWaits;
+    long long notEmptyWaitNs;
+    long long nullPops;
+    long long items;
+} CACHE_ALIGNED Profile;
+
+#ifdef PROFILE
+#define PROF_THREAD(prof, expr) Profile* prof = (expr)
+#define PROF_START(t) long long t = profileNow()
+#define PROF_LAP(t) (t) = profileNow()
+#define PROF_ADD(prof, field, t) (prof)->field##Ns += profileNow() - (t)
+#define PROF_INC(prof, field) (prof)->field++
+#define PROF_DUMP(profs, first, num, title) \
+        printProfiles(profs, first, num, title)
+#else
+#define PROF_THREAD(prof, expr)
+#define PROF_START(t)
+#define PROF_LAP(t)
+#define PROF_ADD(prof, field, t)
+#define PROF_INC(prof, field)
+#define PROF_DUMP(profs, first, num, title) \
+        ((void)(profs), (void)(first), (void)(num), (void)(title))
+#endif
+
+#endif
+
+// Prototype Declarations
+long long profileNow(void);
+Profile* createProfiles(int num);
+void printProfiles(Profile* profs, int first, int num, const char* title);
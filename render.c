@@ -0,0 +1,231 @@
+/* ****************************************************************************
+ * FILE:        render.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Renders the output file's entry for an event (prose, see
+ *              Examples in the README, or a CSV row) into a caller's buffer
+ *              of EVENT_LEN bytes, for both output backends (see output.c).
+ *              Every event is rendered under the building's log lock (and a
+ *              lift's under the buffer lock too), so nothing here goes near
+ *              printf: the fixed text is copied from static fragments whose
+ *              lengths are known at compile time, and numbers are converted 
+ *              two digits at a time from a table.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "render.h"
+
+// Copy a string literal (without its '\0') to p and move p past it
+#define PUT_TEXT(p, text) \
+    do \
+    { \
+        memcpy((p), (text), sizeof(text) - 1); \
+        (p) += sizeof(text) - 1; \
+    } while (0)
+
+// Convert an int at p and move p past it
+#define PUT_INT(p, value) ((p) += renderInt((p), (value)))
+
+#define RULE "------------------------------------------\n"
+
+// "00" to "99": the digits of every number below 100, two chars each
+static const char digitPairs[201] =
+    "00010203040506070809" "10111213141516171819"
+    "20212223242526272829" "30313233343536373839"
+    "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879"
+    "80818283848586878889" "90919293949596979899";
+
+/* ****************************************************************************
+ * NAME:        renderInt
+ *
+ * PURPOSE:     Convert an int to decimal, as printf's %d would. The digits
+ *              are produced from the right, two per division by 100.
+ *
+ * IMPORT:      out - at least INT_TEXT_LEN bytes
+ *              value - the number
+ * EXPORT:      Number of chars written (out is '\0' terminated after them)
+ * ***************************************************************************/
+int renderInt(char* out, int value)
+{
+    char digits[INT_TEXT_LEN];
+    char* p = digits + INT_TEXT_LEN;
+    unsigned int left = (value < 0) ? 0u - (unsigned int)value :
+                                      (unsigned int)value;
+
+    while (left >= 100)
+    {
+        unsigned int pair = (left % 100) * 2;
+        left /= 100;
+        p -= 2;
+        p[0] = digitPairs[pair];
+        p[1] = digitPairs[pair + 1];
+    }
+
+    if (left >= 10)
+    {
+        p -= 2;
+        p[0] = digitPairs[left * 2];
+        p[1] = digitPairs[left * 2 + 1];
+    }
+    else
+    {
+        *--p = (char)('0' + left);
+    }
+
+    if (value < 0)
+    {
+        *--p = '-';
+    }
+
+    int len = (int)(digits + INT_TEXT_LEN - p);
+    memcpy(out, p, len);
+    out[len] = '\0';
+
+    return len;
+}
+
+/* ****************************************************************************
+ * NAME:        renderRequest
+ *
+ * PURPOSE:     Render a request's entry in the prose log.
+ *
+ * IMPORT:      out - at least EVENT_LEN bytes
+ *              Pointer to a request
+ * EXPORT:      Length of the entry (out is '\0' terminated after it)
+ * ***************************************************************************/
+int renderRequest(char* out, Request* req)
+{
+    char* p = out;
+
+    PUT_TEXT(p, RULE "New Lift Request From Floor ");
+    PUT_INT(p, req->start);
+    PUT_TEXT(p, " to Floor ");
+    PUT_INT(p, req->destination);
+    PUT_TEXT(p, "\nRequest No: ");
+    PUT_INT(p, req->num);
+    PUT_TEXT(p, "\n" RULE "\n");
+    *p = '\0';
+
+    return (int)(p - out);
+}
+
+/* ****************************************************************************
+ * NAME:        renderLiftActivity
+ *
+ * PURPOSE:     Render a lift's operation details in the prose log.
+ *
+ * IMPORT:      out - at least EVENT_LEN bytes
+ *              Pointer to the lift struct (before it moves)
+ *              Pointer to the request
+ * EXPORT:      Length of the entry (out is '\0' terminated after it)
+ * ***************************************************************************/
+int renderLiftActivity(char* out, Lift* lift, Request* req)
+{
+    char* p = out;
+    int numMov = (abs(lift->currFloor - req->start)) +
+                 (abs(req->start - req->destination));
+
+    PUT_TEXT(p, "Lift-");
+    PUT_INT(p, lift->id);
+    PUT_TEXT(p, " Operation\nPrevious position: Floor ");
+    PUT_INT(p, lift->currFloor);
+    PUT_TEXT(p, "\nRequest: Floor ");
+    PUT_INT(p, req->start);
+    PUT_TEXT(p, " to ");
+    PUT_INT(p, req->destination);
+    PUT_TEXT(p, "\nDetail operations:\n");
+
+    if (lift->currFloor != req->start)
+    {
+        PUT_TEXT(p, "    Go from Floor ");
+        PUT_INT(p, lift->currFloor);
+        PUT_TEXT(p, " to Floor ");
+        PUT_INT(p, req->start);
+        PUT_TEXT(p, "\n");
+    }
+
+    PUT_TEXT(p, "    Go from Floor ");
+    PUT_INT(p, req->start);
+    PUT_TEXT(p, " to Floor ");
+    PUT_INT(p, req->destination);
+    PUT_TEXT(p, "\n    #movements for this request: ");
+    PUT_INT(p, numMov);
+    PUT_TEXT(p, "\n    #request: ");
+    PUT_INT(p, lift->numRequests);
+    PUT_TEXT(p, "\n    Total #movement: ");
+    PUT_INT(p, lift->numMovements + numMov);
+    PUT_TEXT(p, "\nCurrent position: Floor ");
+    PUT_INT(p, req->destination);
+    PUT_TEXT(p, "\n\n");
+    *p = '\0';
+
+    return (int)(p - out);
+}
+
+/* ****************************************************************************
+ * NAME:        renderRequestCsv
+ *
+ * PURPOSE:     Render a request's row in the CSV log.
+ *
+ * IMPORT:      out - at least EVENT_LEN bytes
+ *              Pointer to a request
+ * EXPORT:      Length of the row (out is '\0' terminated after it)
+ * ***************************************************************************/
+int renderRequestCsv(char* out, Request* req)
+{
+    char* p = out;
+
+    PUT_TEXT(p, "request,");
+    PUT_INT(p, req->num);
+    PUT_TEXT(p, ",,");
+    PUT_INT(p, req->start);
+    PUT_TEXT(p, ",");
+    PUT_INT(p, req->destination);
+    PUT_TEXT(p, ",,,,\n");
+    *p = '\0';
+
+    return (int)(p - out);
+}
+
+/* ****************************************************************************
+ * NAME:        renderLiftActivityCsv
+ *
+ * PURPOSE:     Render a lift's row in the CSV log, with the same details as
+ *              the prose log.
+ *
+ * IMPORT:      out - at least EVENT_LEN bytes
+ *              Pointer to the lift struct (before it moves)
+ *              Pointer to the request
+ * EXPORT:      Length of the row (out is '\0' terminated after it)
+ * ***************************************************************************/
+int renderLiftActivityCsv(char* out, Lift* lift, Request* req)
+{
+    char* p = out;
+    int numMov = (abs(lift->currFloor - req->start)) +
+                 (abs(req->start - req->destination));
+
+    PUT_TEXT(p, "lift,");
+    PUT_INT(p, req->num);
+    PUT_TEXT(p, ",");
+    PUT_INT(p, lift->id);
+    PUT_TEXT(p, ",");
+    PUT_INT(p, req->start);
+    PUT_TEXT(p, ",");
+    PUT_INT(p, req->destination);
+    PUT_TEXT(p, ",");
+    PUT_INT(p, lift->currFloor);
+    PUT_TEXT(p, ",");
+    PUT_INT(p, numMov);
+    PUT_TEXT(p, ",");
+    PUT_INT(p, lift->numRequests);
+    PUT_TEXT(p, ",");
+    PUT_INT(p, lift->numMovements + numMov);
+    PUT_TEXT(p, "\n");
+    *p = '\0';
+
+    return (int)(p - out);
+}
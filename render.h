@@ -0,0 +1,26 @@
+/* ****************************************************************************
+ * FILE:        render.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Header file for render.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include "lift_sim.h"
+#include "linked_list.h"
+
+#ifndef RENDER
+#define RENDER
+
+#define EVENT_LEN 512 // room for the longest entry of any event, and a '\0'
+#define INT_TEXT_LEN 12 // room for any int ("-2147483648", and a '\0')
+
+#endif
+
+// Prototype Declarations
+int renderInt(char* out, int value);
+int renderRequest(char* out, Request* req);
+int renderLiftActivity(char* out, Lift* lift, Request* req);
+int renderRequestCsv(char* out, Request* req);
+int renderLiftActivityCsv(char* out, Lift* lift, Request* req);
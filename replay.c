@@ -0,0 +1,202 @@
+/* ****************************************************************************
+ * FILE:        replay.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Replays a building's requests through the simulated policy
+ *              in virtual time (see fifoMovement in solve.c): each request
+ *              goes to the lift that is free soonest, and the floors it
+ *              moves are added up.
+ *
+ *              Most buildings have one of a few lift counts, so a kernel is
+ *              generated for each of them (REPLAY_KERNEL): lift state lives
+ *              in fixed-size arrays on the stack and the choice of lift is
+ *              unrolled, with no loop over lifts per request. Leg times come
+ *              from a table by distance (NUM_FLOORS is fixed), instead of
+ *              asking the travel model every leg. Any other lift count runs
+ *              the generic kernel, which gives the same result.
+ *
+ *              The live sims are not specialised, not even with --virtual:
+ *              each lift steps only itself there, and a step costs its lock
+ *              and semaphore handoffs, not its arithmetic (see the README).
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "replay.h"
+
+// Unrolled step of picking the lift free soonest (the lowest id on a tie)
+#define PICK(ii) if (freeAt[ii] < freeAt[next]) { next = ii; }
+
+// Generates replayN, the kernel for N lifts. PICKS = PICK(1) to PICK(N-1).
+#define REPLAY_KERNEL(LIFTS, PICKS) \
+static long long replay##LIFTS(const Replay* replay, int numLifts) \
+{ \
+    long long floors = 0; \
+    int currFloor[LIFTS]; \
+    long long freeAt[LIFTS]; \
+    for (int ii = 0; ii < LIFTS; ii++) \
+    { \
+        currFloor[ii] = GROUND_FLOOR; \
+        freeAt[ii] = 0; \
+    } \
+    for (int ii = 0; ii < replay->numRequests; ii++) \
+    { \
+        int next = 0; \
+        PICKS \
+        int toStart = abs(currFloor[next] - replay->start[ii]); \
+        int toDest = abs(replay->start[ii] - replay->dest[ii]); \
+        if (toStart != 0) \
+        { \
+            freeAt[next] += replay->legMs[toStart]; \
+        } \
+        freeAt[next] += replay->legMs[toDest]; \
+        floors += toStart + toDest; \
+        currFloor[next] = replay->dest[ii]; \
+    } \
+    return floors; \
+}
+
+REPLAY_KERNEL(1, )
+REPLAY_KERNEL(2, PICK(1))
+REPLAY_KERNEL(3, PICK(1) PICK(2))
+REPLAY_KERNEL(4, PICK(1) PICK(2) PICK(3))
+REPLAY_KERNEL(6, PICK(1) PICK(2) PICK(3) PICK(4) PICK(5))
+REPLAY_KERNEL(8, PICK(1) PICK(2) PICK(3) PICK(4) PICK(5) PICK(6) PICK(7))
+
+// Specialised kernels by lift count (NULL = use the generic one)
+static const ReplayKernel kernels[MAX_SPECIALISED_LIFTS + 1] =
+{
+    [1] = replay1, [2] = replay2, [3] = replay3, [4] = replay4,
+    [6] = replay6, [8] = replay8
+};
+
+/* ****************************************************************************
+ * NAME:        createReplay
+ *
+ * PURPOSE:     Flatten a building's requests into arrays, and work out how
+ *              long a leg of each distance takes.
+ *
+ * IMPORT:      requests - every request of the trace
+ *              building - id of the building
+ *              liftDelay - fixed delay of every leg in ms
+ *              travel - travel model of the lifts
+ * EXPORT:      Pointer to the replay
+ * ***************************************************************************/
+Replay* createReplay(LinkedList* requests, int building, int liftDelay,
+                     const TravelModel* travel)
+{
+    Replay* replay = (Replay*)malloc(sizeof(Replay));
+    int count = 0;
+
+    for (RequestNode* node = requests->head; node != NULL; node = node->next)
+    {
+        if (node->req->building == building)
+        {
+            count++;
+        }
+    }
+
+    replay->numRequests = 0;
+    replay->start = (int*)malloc(sizeof(int) * (count + 1));
+    replay->dest = (int*)malloc(sizeof(int) * (count + 1));
+    for (RequestNode* node = requests->head; node != NULL; node = node->next)
+    {
+        if (node->req->building == building)
+        {
+            replay->start[replay->numRequests] = node->req->start;
+            replay->dest[replay->numRequests] = node->req->destination;
+            replay->numRequests++;
+        }
+    }
+
+    for (int ii = 0; ii < NUM_FLOORS; ii++)
+    {
+        int ms = legTimeMs(travel, liftDelay, ii);
+        replay->legMs[ii] = (ms > 0) ? ms : 1;
+    }
+
+    return replay;
+}
+
+/* ****************************************************************************
+ * NAME:        replayKernel
+ *
+ * PURPOSE:     Returns the fastest kernel for a lift count.
+ *
+ * IMPORT:      numLifts - number of lifts (>= 1)
+ * EXPORT:      The specialised kernel, or replayGeneric if there is none
+ * ***************************************************************************/
+ReplayKernel replayKernel(int numLifts)
+{
+    ReplayKernel kernel = replayGeneric;
+
+    if (numLifts <= MAX_SPECIALISED_LIFTS && kernels[numLifts] != NULL)
+    {
+        kernel = kernels[numLifts];
+    }
+
+    return kernel;
+}
+
+/* ****************************************************************************
+ * NAME:        replayGeneric
+ *
+ * PURPOSE:     Kernel for any number of lifts.
+ *
+ * IMPORT:      replay - the requests
+ *              numLifts - number of lifts (>= 1)
+ * EXPORT:      Floors moved
+ * ***************************************************************************/
+long long replayGeneric(const Replay* replay, int numLifts)
+{
+    long long floors = 0;
+    int* currFloor = (int*)malloc(sizeof(int) * numLifts);
+    long long* freeAt = (long long*)malloc(sizeof(long long) * numLifts);
+
+    for (int ii = 0; ii < numLifts; ii++)
+    {
+        currFloor[ii] = GROUND_FLOOR;
+        freeAt[ii] = 0;
+    }
+
+    for (int ii = 0; ii < replay->numRequests; ii++)
+    {
+        int next = 0;
+        for (int jj = 1; jj < numLifts; jj++)
+        {
+            PICK(jj)
+        }
+
+        int toStart = abs(currFloor[next] - replay->start[ii]);
+        int toDest = abs(replay->start[ii] - replay->dest[ii]);
+        if (toStart != 0)
+        {
+            freeAt[next] += replay->legMs[toStart];
+        }
+        freeAt[next] += replay->legMs[toDest];
+
+        floors += toStart + toDest;
+        currFloor[next] = replay->dest[ii];
+    }
+
+    free(currFloor);
+    free(freeAt);
+
+    return floors;
+}
+
+/* ****************************************************************************
+ * NAME:        freeReplay
+ *
+ * PURPOSE:     Free a replay.
+ *
+ * IMPORT:      Pointer to the replay
+ * ***************************************************************************/
+void freeReplay(Replay* replay)
+{
+    free(replay->start);
+    free(replay->dest);
+    free(replay);
+}
@@ -0,0 +1,41 @@
+/* ****************************************************************************
+ * FILE:        replay.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Header file for replay.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include "lift_sim.h"
+#include "linked_list.h"
+#include "travel.h"
+
+#ifndef REPLAY
+#define REPLAY
+
+// Largest lift count with a specialised kernel (see replayKernel)
+#define MAX_SPECIALISED_LIFTS 8
+
+// One building's requests, in order, ready to replay
+// start / dest = floors of each request
+// legMs = how long a leg of each distance takes (at least 1 ms)
+typedef struct Replay
+{
+    int numRequests;
+    int* start;
+    int* dest;
+    int legMs[NUM_FLOORS];
+} Replay;
+
+// Replays the requests and returns the floors moved
+typedef long long (*ReplayKernel)(const Replay* replay, int numLifts);
+
+#endif
+
+// Prototype Declarations
+Replay* createReplay(LinkedList* requests, int building, int liftDelay,
+                     const TravelModel* travel);
+ReplayKernel replayKernel(int numLifts);
+long long replayGeneric(const Replay* replay, int numLifts);
+void freeReplay(Replay* replay);
@@ -0,0 +1,228 @@
+/* ****************************************************************************
+ * FILE:        ring.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     A bounded, lock-free, multi-producer multi-consumer ring of
+ *              requests (after Dmitry Vyukov's bounded MPMC queue).
+ *
+ *              Every cell carries a sequence number: a cell at position pos
+ *              is free for the producer of pos when seq == pos, and holds a
+ *              request for the consumer of pos when seq == pos + 1. Producers
+ *              and consumers claim positions with a compare-and-swap on head
+ *              and tail, so nobody ever takes a lock, and since the ring is 
+ *              one block of plain memory it can live in a shared memory 
+ *              segment used by several processes.
+ *
+ *              The ring itself never blocks: pushRing() and popRing() fail
+ *              when it is full or empty, and callers wait with semaphores.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "ring.h"
+
+/* ****************************************************************************
+ * NAME:        ringBytes
+ * 
+ * PURPOSE:     Returns the memory needed for a ring holding at least 
+ *              capacity requests.
+ * 
+ * IMPORT:      capacity - number of requests (>= 1)
+ * EXPORT:      Size in bytes
+ * ***************************************************************************/
+size_t ringBytes(int capacity)
+{
+    int size = 1;
+    while (size < capacity)
+    {
+        size *= 2;
+    }
+
+    return sizeof(Ring) + sizeof(RingCell) * size;
+}
+
+/* ****************************************************************************
+ * NAME:        initRing
+ * 
+ * PURPOSE:     Prepare an empty ring in a block of ringBytes(capacity) bytes.
+ *              The capacity is rounded up to a power of two.
+ * 
+ * IMPORT:      ring - the memory block
+ *              capacity - number of requests (>= 1)
+ * ***************************************************************************/
+void initRing(Ring* ring, int capacity)
+{
+    int size = 1;
+    while (size < capacity)
+    {
+        size *= 2;
+    }
+
+    ring->size = size;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    for (int ii = 0; ii < size; ii++)
+    {
+        ring->cells[ii].seq = ii;
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        pushRing
+ * 
+ * PURPOSE:     Copy a request into the ring.
+ * 
+ * IMPORT:      ring - the ring
+ *              req - the request (copied)
+ * EXPORT:      Error code (-1 = ring is full)
+ * ***************************************************************************/
+int pushRing(Ring* ring, const Request* req)
+{
+    int status = 1;
+    long long pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    RingCell* cell = NULL;
+
+    while (status == 1)
+    {
+        cell = &ring->cells[pos & ring->mask];
+        long long seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+
+        if (seq == pos)
+        {
+            // Free cell: claim the position (pos is reloaded on failure)
+            if (__atomic_compare_exchange_n(&ring->head, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                status = 0;
+            }
+        }
+        else if (seq < pos)
+        {
+            status = -1; // a whole lap behind: full
+        }
+        else
+        {
+            pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (status == 0)
+    {
+        cell->req = *req;
+        __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        popRing
+ * 
+ * PURPOSE:     Copy the oldest request out of the ring and remove it.
+ * 
+ * IMPORT:      ring - the ring
+ *              out - where to copy the request
+ * EXPORT:      Error code (-1 = ring is empty)
+ * ***************************************************************************/
+int popRing(Ring* ring, Request* out)
+{
+    int status = 1;
+    long long pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    RingCell* cell = NULL;
+
+    while (status == 1)
+    {
+        cell = &ring->cells[pos & ring->mask];
+        long long seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+
+        if (seq == pos + 1)
+        {
+            // Filled cell: claim the position (pos is reloaded on failure)
+            if (__atomic_compare_exchange_n(&ring->tail, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                status = 0;
+            }
+        }
+        else if (seq < pos + 1)
+        {
+            status = -1; // producer hasn't filled it yet: empty
+        }
+        else
+        {
+            pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (status == 0)
+    {
+        *out = cell->req;
+        __atomic_store_n(&cell->seq, pos + ring->size, __ATOMIC_RELEASE);
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        peekRing
+ * 
+ * PURPOSE:     Copy the oldest request out of the ring without removing it.
+ *              Only meaningful when consumers are serialised by a lock.
+ * 
+ * IMPORT:      ring - the ring
+ *              out - where to copy the request
+ * EXPORT:      Error code (-1 = ring is empty)
+ * ***************************************************************************/
+int peekRing(Ring* ring, Request* out)
+{
+    int status = -1;
+    long long pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    RingCell* cell = &ring->cells[pos & ring->mask];
+
+    if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) == pos + 1)
+    {
+        *out = cell->req;
+        status = 0;
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        ringCount
+ * 
+ * PURPOSE:     Returns the number of requests in the ring. Only exact while
+ *              nobody is pushing or popping.
+ * 
+ * IMPORT:      ring - the ring
+ * EXPORT:      Number of requests
+ * ***************************************************************************/
+int ringCount(Ring* ring)
+{
+    return (int)(__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - 
+                 __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+}
+
+/* ****************************************************************************
+ * NAME:        repairRing
+ * 
+ * PURPOSE:     Finish a pop that a consumer started but never completed (it
+ *              claimed the cell, then died before handing the cell back to 
+ *              the producers). Only safe while consumers are serialised by a
+ *              lock and the dead consumer held it.
+ * 
+ * IMPORT:      ring - the ring
+ * ***************************************************************************/
+void repairRing(Ring* ring)
+{
+    long long pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED) - 1;
+    RingCell* cell = &ring->cells[pos & ring->mask];
+
+    if (pos >= 0 && __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) == pos + 1)
+    {
+        __atomic_store_n(&cell->seq, pos + ring->size, __ATOMIC_RELEASE);
+    }
+}
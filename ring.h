@@ -0,0 +1,47 @@
+/* ****************************************************************************
+ * FILE:        ring.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for ring.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stddef.h>
+#include "linked_list.h"
+#include "cache.h"
+
+#ifndef RING
+#define RING
+
+// One slot of the ring. seq tells producers and consumers whose turn the
+// slot is, and the request is stored by value (no pointers, so the ring 
+// works in memory shared between processes).
+typedef struct RingCell
+{
+    long long seq;
+    Request req;
+} RingCell;
+
+// A bounded lock-free ring, laid out in one block of memory.
+// head = next position to push (producers), tail = next position to pop
+// (consumers), each on its own cache line. size is a power of two.
+typedef struct Ring
+{
+    int size;
+    int mask;
+    CACHE_ALIGNED long long head;
+    CACHE_ALIGNED long long tail;
+    CACHE_ALIGNED RingCell cells[];
+} Ring;
+
+#endif
+
+// Prototype Declarations
+size_t ringBytes(int capacity);
+void initRing(Ring* ring, int capacity);
+int pushRing(Ring* ring, const Request* req);
+int popRing(Ring* ring, Request* out);
+int peekRing(Ring* ring, Request* out);
+int ringCount(Ring* ring);
+void repairRing(Ring* ring);
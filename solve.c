@@ -0,0 +1,604 @@
+/* ****************************************************************************
+ * FILE:        solve.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Works out how far the simulated policy (lifts take requests
+ *              in order, whichever lift is free first) is from the best
+ *              possible schedule of a trace (--solve), in floors moved.
+ *
+ *              Every schedule moves the same floors carrying passengers, so
+ *              only the empty legs (to each pickup) differ. Each request's
+ *              empty leg starts where its lift dropped off its last request,
+ *              or on the ground floor for a lift's first request. Letting
+ *              every request pick any drop-off (or a lift on the ground
+ *              floor) to start from, each used once, can only make things
+ *              cheaper, and with only 20 floors that is a tiny min-cost flow
+ *              from drop-off floors to pickup floors: the lower bound (see
+ *              emptyBound).
+ *
+ *              Real schedules are found by a randomised greedy search run on
+ *              every core: the nearest free lift always takes the nearest
+ *              waiting request, dropping it near another waiting request.
+ *              Schedules only depend on which lift serves which requests in
+ *              what order, not when, so requests are just counted by floors.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "solve.h"
+#include "fileio.h"
+#include "travel.h"
+#include "replay.h"
+
+// Nodes of the flow network: drop-off floor f is node f, pickup floor g is
+// node NUM_FLOORS + g
+#define SOURCE 0
+#define SINK (2 * NUM_FLOORS + 1)
+#define NODES (2 * NUM_FLOORS + 2)
+
+// One search thread, best = least empty movement it found
+typedef struct SearchThread
+{
+    Trips* trips;
+    int numLifts;
+    long long target;
+    unsigned int seed;
+    int* found;
+    long long best;
+    long long restarts;
+} SearchThread;
+
+static long long minCostFlow(const long long* dropoffs, 
+                             const long long* pickups, long long lifts);
+static void* searchSchedules(void* arg);
+static long long greedySchedule(Trips trips, int numLifts, unsigned int* seed,
+                                int explore, long long cutoff);
+static void nearestWaiting(const long long* waiting, int* near);
+
+/* ****************************************************************************
+ * NAME:        solveTrace
+ *
+ * PURPOSE:     Read a trace and print, for every building in it, the lower
+ *              bound, the best schedule found and the simulated policy.
+ *
+ * IMPORT:      filename - the trace
+ *              opts - number of lifts, lift delay and travel model
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int solveTrace(char* filename, Options* opts)
+{
+    int status = 0;
+    Solution sol;
+    LinkedList* requests = createLinkedList();
+
+    if (readRequests(filename, requests, GROUND_FLOOR, NUM_FLOORS) == -1)
+    {
+        printf("failed to read %s\n", filename);
+        status = -1;
+    }
+    else
+    {
+        for (int ii = 1; ii <= MAX_BUILDINGS; ii++)
+        {
+            solveBuilding(requests, ii, opts, &sol);
+            if (sol.requests > 0)
+            {
+                printf("building %d: %lld requests, %d lifts\n", ii,
+                       sol.requests, opts->numLifts);
+                printf("    carrying passengers: %lld floors (in every "
+                       "schedule)\n", sol.carrying);
+                printf("    lower bound: %lld floors\n", sol.bound);
+                printf("    best schedule found: %lld floors%s (%lld "
+                       "restarts on %d thread%s)\n", sol.best,
+                       (sol.best == sol.bound) ? ", optimal" : "",
+                       sol.restarts, sol.threads, 
+                       (sol.threads == 1) ? "" : "s");
+                printf("    simulated (FIFO): %lld floors, %+.1f%% over the "
+                       "bound\n", sol.fifo, (sol.bound > 0) ? 
+                       100.0 * (sol.fifo - sol.bound) / sol.bound : 0.0);
+            }
+        }
+    }
+
+    freeLinkedList(requests);
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        solveBuilding
+ *
+ * PURPOSE:     Solve the requests of one building.
+ *
+ * IMPORT:      requests - every request of the trace
+ *              building - id of the building
+ *              opts - number of lifts, lift delay and travel model
+ *              sol - filled in (requests = 0 if the building has none)
+ * ***************************************************************************/
+void solveBuilding(LinkedList* requests, int building, Options* opts,
+                   Solution* sol)
+{
+    Trips trips;
+
+    memset(trips, 0, sizeof(Trips));
+    memset(sol, 0, sizeof(Solution));
+    for (RequestNode* node = requests->head; node != NULL; node = node->next)
+    {
+        if (node->req->building == building)
+        {
+            trips[node->req->start][node->req->destination]++;
+            sol->requests++;
+        }
+    }
+
+    if (sol->requests > 0)
+    {
+        long long emptyMin = emptyBound(trips, opts->numLifts);
+
+        sol->carrying = carryingMovement(trips);
+        sol->bound = sol->carrying + emptyMin;
+        sol->best = sol->carrying + bestSchedule(trips, opts->numLifts,
+                                                 emptyMin, &sol->restarts,
+                                                 &sol->threads);
+        sol->fifo = fifoMovement(requests, building, opts);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        carryingMovement
+ *
+ * PURPOSE:     Floors moved with a passenger, by any schedule.
+ *
+ * IMPORT:      trips - the requests
+ * EXPORT:      Floors
+ * ***************************************************************************/
+long long carryingMovement(Trips trips)
+{
+    long long floors = 0;
+
+    for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+    {
+        for (int jj = GROUND_FLOOR; jj <= NUM_FLOORS; jj++)
+        {
+            floors += trips[ii][jj] * abs(ii - jj);
+        }
+    }
+
+    return floors;
+}
+
+/* ****************************************************************************
+ * NAME:        emptyBound
+ *
+ * PURPOSE:     Lower bound on the floors moved empty. Some lift has to go
+ *              from the ground floor to its first pickup; after that, every
+ *              other pickup needs a drop-off (or another lift on the ground
+ *              floor) to start from, which is solved as a min-cost flow. 
+ *              Trying every floor for that first pickup stops the flow from
+ *              only chaining requests into loops that no lift ever reaches.
+ *
+ * IMPORT:      trips - the requests
+ *              numLifts - lifts starting on the ground floor
+ * EXPORT:      Floors
+ * ***************************************************************************/
+long long emptyBound(Trips trips, int numLifts)
+{
+    long long pickups[NUM_FLOORS + 1], dropoffs[NUM_FLOORS + 1];
+    long long floors = LLONG_MAX;
+
+    for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+    {
+        pickups[ii] = 0;
+        dropoffs[ii] = 0;
+    }
+    for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+    {
+        for (int jj = GROUND_FLOOR; jj <= NUM_FLOORS; jj++)
+        {
+            pickups[ii] += trips[ii][jj];
+            dropoffs[jj] += trips[ii][jj];
+        }
+    }
+
+    for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+    {
+        if (pickups[ii] > 0)
+        {
+            pickups[ii]--;
+            long long first = abs(ii - GROUND_FLOOR) + 
+                              minCostFlow(dropoffs, pickups, numLifts - 1);
+            pickups[ii]++;
+
+            if (first < floors)
+            {
+                floors = first;
+            }
+        }
+    }
+
+    return (floors == LLONG_MAX) ? 0 : floors;
+}
+
+/* ****************************************************************************
+ * NAME:        minCostFlow
+ *
+ * PURPOSE:     The cheapest way of giving every pickup a drop-off, or a lift
+ *              on the ground floor, to start from (each used once at most).
+ *              Solved with successive shortest paths; the network only has
+ *              42 nodes, and each path carries as many requests as it can.
+ *
+ * IMPORT:      dropoffs - drop-offs on each floor
+ *              pickups - pickups on each floor
+ *              lifts - lifts waiting on the ground floor
+ * EXPORT:      Floors moved empty
+ * ***************************************************************************/
+static long long minCostFlow(const long long* dropoffs, 
+                             const long long* pickups, long long lifts)
+{
+    long long cap[NODES][NODES];
+    int cost[NODES][NODES];
+    long long dist[NODES];
+    int prev[NODES];
+    long long needed = 0, floors = 0;
+
+    memset(cap, 0, sizeof(cap));
+    memset(cost, 0, sizeof(cost));
+    for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+    {
+        cap[SOURCE][ii] = dropoffs[ii];
+        cap[NUM_FLOORS + ii][SINK] = pickups[ii];
+        needed += pickups[ii];
+    }
+    cap[SOURCE][GROUND_FLOOR] += lifts;
+
+    for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+    {
+        for (int jj = GROUND_FLOOR; jj <= NUM_FLOORS; jj++)
+        {
+            cap[ii][NUM_FLOORS + jj] = needed;
+            cost[ii][NUM_FLOORS + jj] = abs(ii - jj);
+            cost[NUM_FLOORS + jj][ii] = -abs(ii - jj);
+        }
+    }
+
+    int done = 0;
+    while (!done)
+    {
+        // Cheapest path with room left (Bellman-Ford, undoing is negative)
+        for (int ii = 0; ii < NODES; ii++)
+        {
+            dist[ii] = LLONG_MAX;
+            prev[ii] = -1;
+        }
+        dist[SOURCE] = 0;
+
+        int changed = 1;
+        for (int round = 0; round < NODES && changed; round++)
+        {
+            changed = 0;
+            for (int ii = 0; ii < NODES; ii++)
+            {
+                for (int jj = 0; dist[ii] != LLONG_MAX && jj < NODES; jj++)
+                {
+                    if (cap[ii][jj] > 0 && dist[ii] + cost[ii][jj] < dist[jj])
+                    {
+                        dist[jj] = dist[ii] + cost[ii][jj];
+                        prev[jj] = ii;
+                        changed = 1;
+                    }
+                }
+            }
+        }
+
+        if (dist[SINK] == LLONG_MAX)
+        {
+            done = 1; // every pickup has somewhere to start from
+        }
+        else
+        {
+            long long push = LLONG_MAX;
+            for (int node = SINK; node != SOURCE; node = prev[node])
+            {
+                if (cap[prev[node]][node] < push)
+                {
+                    push = cap[prev[node]][node];
+                }
+            }
+            for (int node = SINK; node != SOURCE; node = prev[node])
+            {
+                cap[prev[node]][node] -= push;
+                cap[node][prev[node]] += push;
+            }
+            floors += push * dist[SINK];
+        }
+    }
+
+    return floors;
+}
+
+/* ****************************************************************************
+ * NAME:        bestSchedule
+ *
+ * PURPOSE:     Search for the schedule moving empty the least, on one thread
+ *              per core. Threads stop early once one reaches the target.
+ *
+ * IMPORT:      trips - the requests
+ *              numLifts - lifts in the building
+ *              target - stop if a schedule gets down to this (the bound)
+ *              restarts - set to the schedules tried
+ *              threads - set to the threads used
+ * EXPORT:      Floors moved empty by the best schedule
+ * ***************************************************************************/
+long long bestSchedule(Trips trips, int numLifts, long long target,
+                       long long* restarts, int* threads)
+{
+    long long best = LLONG_MAX;
+    int found = 0;
+
+    long long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+    int numThreads = (numCores > 0) ? (int)numCores : 1;
+    if (numThreads > MAX_SOLVE_THREADS)
+    {
+        numThreads = MAX_SOLVE_THREADS;
+    }
+
+    SearchThread* search = (SearchThread*)malloc(sizeof(SearchThread) *
+                                                 numThreads);
+    pthread_t* tids = (pthread_t*)malloc(sizeof(pthread_t) * numThreads);
+    for (int ii = 0; ii < numThreads; ii++)
+    {
+        search[ii].trips = (Trips*)trips;
+        search[ii].numLifts = numLifts;
+        search[ii].target = target;
+        search[ii].seed = 2654435761u * (ii + 1);
+        search[ii].found = &found;
+    }
+
+    for (int ii = 1; ii < numThreads; ii++)
+    {
+        pthread_create(&tids[ii], NULL, searchSchedules, &search[ii]);
+    }
+    searchSchedules(&search[0]);
+
+    *restarts = 0;
+    for (int ii = 0; ii < numThreads; ii++)
+    {
+        if (ii > 0)
+        {
+            pthread_join(tids[ii], NULL);
+        }
+        *restarts += search[ii].restarts;
+        if (search[ii].best < best)
+        {
+            best = search[ii].best;
+        }
+    }
+    *threads = numThreads;
+
+    free(search);
+    free(tids);
+
+    return best;
+}
+
+/* ****************************************************************************
+ * NAME:        fifoMovement
+ *
+ * PURPOSE:     Replay the simulated policy: requests are taken in order by
+ *              the lift that is free soonest (the lowest id on a tie), each
+ *              leg taking as long as the travel model says. Legs take at
+ *              least 1 ms, so lifts with no delay still take turns. Common
+ *              lift counts run a specialised kernel (see replay.c).
+ *
+ * IMPORT:      requests - every request of the trace
+ *              building - id of the building
+ *              opts - number of lifts, lift delay and travel model
+ * EXPORT:      Floors moved
+ * ***************************************************************************/
+long long fifoMovement(LinkedList* requests, int building, Options* opts)
+{
+    Replay* replay = createReplay(requests, building, opts->liftDelay, 
+                                  &opts->travel);
+    long long floors = replayKernel(opts->numLifts)(replay, opts->numLifts);
+    freeReplay(replay);
+
+    return floors;
+}
+
+/* ****************************************************************************
+ * NAME:        searchSchedules
+ *
+ * PURPOSE:     Thread body: run the greedy search over and over, randomised
+ *              after the first time, for SOLVE_STEPS requests placed or
+ *              until some thread reaches the target.
+ *
+ * IMPORT:      Pointer to the search thread
+ * ***************************************************************************/
+static void* searchSchedules(void* arg)
+{
+    SearchThread* search = (SearchThread*)arg;
+    long long steps = 0, requests = 0;
+
+    for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+    {
+        for (int jj = GROUND_FLOOR; jj <= NUM_FLOORS; jj++)
+        {
+            requests += (*search->trips)[ii][jj];
+        }
+    }
+
+    search->best = LLONG_MAX;
+    search->restarts = 0;
+    while ((search->restarts == 0 || steps < SOLVE_STEPS) &&
+           __atomic_load_n(search->found, __ATOMIC_RELAXED) == 0)
+    {
+        long long empty = greedySchedule(*search->trips, search->numLifts,
+                                         &search->seed, search->restarts > 0,
+                                         search->best);
+        if (empty < search->best)
+        {
+            search->best = empty;
+        }
+        if (search->best <= search->target)
+        {
+            __atomic_store_n(search->found, 1, __ATOMIC_RELAXED);
+        }
+
+        steps += requests + 1;
+        search->restarts++;
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        greedySchedule
+ *
+ * PURPOSE:     Build one schedule: over and over, the free lift nearest to
+ *              a waiting request takes it, and of the requests waiting there
+ *              the one dropped off nearest another waiting request goes
+ *              first. Ties are broken at random, and when exploring a
+ *              quarter of the drop-offs are picked at random.
+ *
+ * IMPORT:      trips - the requests
+ *              numLifts - lifts starting on the ground floor
+ *              seed - random state of the calling thread
+ *              explore - randomise drop-offs as well as ties
+ *              cutoff - give up once the schedule is this bad
+ * EXPORT:      Floors moved empty (cutoff if it gave up)
+ * ***************************************************************************/
+static long long greedySchedule(Trips trips, int numLifts, unsigned int* seed,
+                                int explore, long long cutoff)
+{
+    Trips left;
+    long long waiting[NUM_FLOORS + 1], ends[NUM_FLOORS + 1];
+    int near[NUM_FLOORS + 1];
+    long long remaining = 0, empty = 0;
+
+    memcpy(left, trips, sizeof(Trips));
+    for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+    {
+        waiting[ii] = 0;
+        for (int jj = GROUND_FLOOR; jj <= NUM_FLOORS; jj++)
+        {
+            waiting[ii] += left[ii][jj];
+        }
+        remaining += waiting[ii];
+        ends[ii] = 0; // lifts free on each floor
+    }
+    ends[GROUND_FLOOR] = numLifts;
+
+    while (remaining > 0 && empty < cutoff)
+    {
+        int from = 0, start = 0, dest = 0, ties = 0;
+        int best = INT_MAX;
+
+        for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+        {
+            for (int jj = GROUND_FLOOR; waiting[ii] > 0 && jj <= NUM_FLOORS;
+                 jj++)
+            {
+                if (ends[jj] > 0)
+                {
+                    int dist = abs(ii - jj);
+                    if (dist < best)
+                    {
+                        best = dist;
+                        ties = 1;
+                        from = jj;
+                        start = ii;
+                    }
+                    else if (dist == best && rand_r(seed) % ++ties == 0)
+                    {
+                        from = jj;
+                        start = ii;
+                    }
+                }
+            }
+        }
+
+        waiting[start]--;
+        nearestWaiting(waiting, near);
+
+        best = INT_MAX;
+        ties = 0;
+        for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+        {
+            if (left[start][ii] > 0)
+            {
+                int score = near[ii];
+                if (explore && rand_r(seed) % 4 == 0)
+                {
+                    score = rand_r(seed) % NUM_FLOORS;
+                }
+
+                if (score < best)
+                {
+                    best = score;
+                    ties = 1;
+                    dest = ii;
+                }
+                else if (score == best && rand_r(seed) % ++ties == 0)
+                {
+                    dest = ii;
+                }
+            }
+        }
+
+        left[start][dest]--;
+        ends[from]--;
+        ends[dest]++;
+        empty += abs(from - start);
+        remaining--;
+    }
+
+    return (empty < cutoff) ? empty : cutoff;
+}
+
+/* ****************************************************************************
+ * NAME:        nearestWaiting
+ *
+ * PURPOSE:     For every floor, how far it is to the nearest floor with a
+ *              request waiting (0 if none are left).
+ *
+ * IMPORT:      waiting - requests waiting on each floor
+ *              near - filled in with the distances
+ * ***************************************************************************/
+static void nearestWaiting(const long long* waiting, int* near)
+{
+    int last = -1;
+
+    // Nearest below (or on), then nearest above
+    for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+    {
+        if (waiting[ii] > 0)
+        {
+            last = ii;
+        }
+        near[ii] = (last == -1) ? INT_MAX : ii - last;
+    }
+
+    last = -1;
+    for (int ii = NUM_FLOORS; ii >= GROUND_FLOOR; ii--)
+    {
+        if (waiting[ii] > 0)
+        {
+            last = ii;
+        }
+        if (last != -1 && last - ii < near[ii])
+        {
+            near[ii] = last - ii;
+        }
+        if (near[ii] == INT_MAX)
+        {
+            near[ii] = 0; // nothing left to pick up
+        }
+    }
+}
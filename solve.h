@@ -0,0 +1,52 @@
+/* ****************************************************************************
+ * FILE:        solve.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Header file for solve.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include "lift_sim.h"
+#include "linked_list.h"
+#include "options.h"
+
+#ifndef SOLVE
+#define SOLVE
+
+// Greedy steps (requests placed) each search thread takes before stopping,
+// so small traces get many restarts and big ones at least one
+#define SOLVE_STEPS (1 << 18)
+#define MAX_SOLVE_THREADS 64
+
+// Requests counted by start floor (row) and destination floor (column).
+// Requests with the same floors are interchangeable to every schedule.
+typedef long long Trips[NUM_FLOORS + 1][NUM_FLOORS + 1];
+
+// Movement of one building's schedules, in floors
+// carrying = floors moved with a passenger, the same for every schedule
+// bound = no schedule can move less, best = best schedule found
+// fifo = the simulated policy (see fifoMovement)
+// restarts / threads = how hard the search tried
+typedef struct Solution
+{
+    long long requests;
+    long long carrying;
+    long long bound;
+    long long best;
+    long long fifo;
+    long long restarts;
+    int threads;
+} Solution;
+
+#endif
+
+// Prototype Declarations
+int solveTrace(char* filename, Options* opts);
+void solveBuilding(LinkedList* requests, int building, Options* opts,
+                   Solution* sol);
+long long carryingMovement(Trips trips);
+long long emptyBound(Trips trips, int numLifts);
+long long bestSchedule(Trips trips, int numLifts, long long target,
+                       long long* restarts, int* threads);
+long long fifoMovement(LinkedList* requests, int building, Options* opts);
@@ -0,0 +1,466 @@
+/* ****************************************************************************
+ * FILE:        stress_sim.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Stress test of the real producer/consumer loops. Runs
+ *              lift_sim_A and lift_sim_B over and over with random inputs,
+ *              buffer sizes (1 to 1024), lift counts (1 to 256), lift delays,
+ *              travel models and (in A) request thread counts and output
+ *              backends, and checks from the CSV log of every run:
+ *                  - the run finished (within STRESS_TIMEOUT_MS) and exited
+ *                  - every request was added once and served once, after
+ *                    it was added
+ *                  - requests were numbered in the order they were added
+ *                  - the buffer never held more than its size
+ *                  - every lift's counters and position follow on from its
+ *                    previous operation
+ *
+ *              Both sims log a request being served before its buffer slot
+ *              is freed, and a new request only once there is room for it,
+ *              so the log never shows more queued than the buffer size.
+ *
+ *              Runs happen in a fresh directory under /tmp. A failing run's
+ *              settings are printed along with the seed, to replay it.
+ *
+ *              Usage: ./stress_sim <optional_runs> <optional_seed>
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "lift_sim.h"
+#include "linked_list.h"
+#include "fileio.h"
+#include "travel.h"
+
+#define STRESS_RUNS 1000
+#define STRESS_TIMEOUT_MS 60000
+#define STRESS_MAX_BUFFER 1024
+#define STRESS_MAX_LIFTS 256
+#define STRESS_MAX_BUILDINGS 3
+#define STRESS_MAX_PRODUCERS 8
+
+// The settings of one run
+typedef struct StressRun
+{
+    int implB;
+    int bufferSize;
+    int numLifts;
+    int delayMs;
+    int numBuildings;
+    int numProducers;
+    int priorities;
+    int batch;
+    TravelModel travel;
+} StressRun;
+
+// What a run's logs must show (each building numbers its requests from 1)
+// added / served = times each request of a building was logged
+typedef struct StressCheck
+{
+    int numRequests[STRESS_MAX_BUILDINGS + 1];
+    int added[MAX_REQ + 1];
+    int served[MAX_REQ + 1];
+    char reason[256];
+} StressCheck;
+
+static void randomRun(StressRun* run);
+static int randomScale(int max);
+static int writeInput(const StressRun* run, StressCheck* check);
+static int runSim(const char* exe, const StressRun* run, StressCheck* check);
+static int checkLog(const char* path, int numRequests, const StressRun* run,
+                    StressCheck* check);
+
+int main(int argc, char *argv[])
+{
+    int runs = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : STRESS_RUNS;
+    unsigned int seed = (argc > 2) ? (unsigned int)atol(argv[2])
+                                   : (unsigned int)getpid();
+    char exeA[PATH_MAX], exeB[PATH_MAX];
+    char dir[] = "/tmp/stress_sim_XXXXXX";
+    int passed[2] = { 0, 0 }, failed[2] = { 0, 0 };
+    StressRun run;
+    static StressCheck check;
+
+    if (realpath("lift_sim_A", exeA) == NULL ||
+        realpath("lift_sim_B", exeB) == NULL)
+    {
+        perror("build lift_sim_A and lift_sim_B first (make a b)");
+    }
+    else if (mkdtemp(dir) == NULL || chdir(dir) == -1)
+    {
+        perror("there was an error creating the stress directory");
+    }
+    else
+    {
+        printf("stress_sim: %d runs, seed %u, in %s\n", runs, seed, dir);
+        srand(seed);
+
+        for (int ii = 0; ii < runs; ii++)
+        {
+            randomRun(&run);
+            run.implB = ii % 2;
+
+            int status = writeInput(&run, &check);
+            if (status == 0)
+            {
+                status = runSim(run.implB ? exeB : exeA, &run, &check);
+            }
+
+            if (status == 0)
+            {
+                passed[run.implB]++;
+            }
+            else
+            {
+                failed[run.implB]++;
+                printf("run %d (lift_sim_%c, buffer %d, %d lifts, delay %d "
+                       "ms, travel %d,%d,%d, %d buildings, %d producers, "
+                       "priorities %s, output %s): FAILED, %s\n", ii + 1, 
+                       run.implB ? 'B' : 'A', run.bufferSize, run.numLifts, 
+                       run.delayMs, run.travel.floorMs, run.travel.accelMs,
+                       run.travel.doorMs, run.numBuildings, run.numProducers,
+                       run.priorities ? "on" : "off", 
+                       (run.batch && !run.implB) ? "batch" : "stdio", 
+                       check.reason);
+            }
+        }
+
+        for (int ii = 0; ii < 2; ii++)
+        {
+            printf("lift_sim_%c: %d/%d runs %s\n", 'A' + ii, passed[ii],
+                   passed[ii] + failed[ii],
+                   failed[ii] == 0 ? "PASSED" : "FAILED");
+        }
+
+        // Only clean up if there is nothing left to look into
+        if (failed[0] + failed[1] == 0)
+        {
+            remove("input.csv");
+            remove("sim_out.csv");
+            for (int ii = 2; ii <= STRESS_MAX_BUILDINGS; ii++)
+            {
+                char name[OUT_NAME_LEN];
+                snprintf(name, sizeof(name), OUT_FILE_FMT, ii);
+                remove(name);
+            }
+            rmdir(dir);
+        }
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        randomRun
+ *
+ * PURPOSE:     Pick random settings for a run. Sizes are spread evenly over
+ *              powers of two so small buffers and few lifts come up as often
+ *              as big ones. Most runs have no delay, to get through many.
+ *
+ * IMPORT:      run - filled in (implB is left alone)
+ * ***************************************************************************/
+static void randomRun(StressRun* run)
+{
+    run->bufferSize = randomScale(STRESS_MAX_BUFFER);
+    run->numLifts = randomScale(STRESS_MAX_LIFTS);
+    run->delayMs = (rand() % 4 == 0) ? rand() % 3 + 1 : 0;
+    run->numBuildings = rand() % STRESS_MAX_BUILDINGS + 1;
+    run->numProducers = randomScale(STRESS_MAX_PRODUCERS);
+    run->priorities = rand() % 3 == 0;
+    run->batch = rand() % 2;
+    run->travel.floorMs = 0;
+    run->travel.accelMs = 0;
+    run->travel.doorMs = 0;
+    run->travel.virtualTime = 0;
+
+    if (rand() % 4 == 0)
+    {
+        run->travel.floorMs = rand() % 2;
+        run->travel.accelMs = rand() % 2;
+        run->travel.doorMs = rand() % 2;
+        run->travel.virtualTime = rand() % 2;
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        randomScale
+ *
+ * PURPOSE:     Returns a random number from 1 to max, as likely to be in
+ *              any power of two range as any other.
+ *
+ * IMPORT:      max - largest number
+ * EXPORT:      The number
+ * ***************************************************************************/
+static int randomScale(int max)
+{
+    int bits = 0;
+    while ((2 << bits) <= max)
+    {
+        bits++;
+    }
+
+    int low = 1 << (rand() % (bits + 1));
+    int value = low + rand() % low;
+
+    return (value > max) ? max : value;
+}
+
+/* ****************************************************************************
+ * NAME:        writeInput
+ *
+ * PURPOSE:     Write a random input file for a run: MIN_REQ to MAX_REQ
+ *              requests per building (B only simulates one building).
+ *
+ * IMPORT:      run - the settings
+ *              check - numRequests is set for each building
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+static int writeInput(const StressRun* run, StressCheck* check)
+{
+    int status = 0;
+    int numBuildings = run->implB ? 1 : run->numBuildings;
+
+    FILE* file = fopen("input.csv", "w");
+    if (file == NULL)
+    {
+        snprintf(check->reason, sizeof(check->reason), "can't write input");
+        status = -1;
+    }
+    else
+    {
+        for (int ii = 1; ii <= numBuildings; ii++)
+        {
+            int count = MIN_REQ + rand() % (MAX_REQ - MIN_REQ + 1);
+            for (int jj = 0; jj < count; jj++)
+            {
+                fprintf(file, "%d %d %d %d\n", rand() % NUM_FLOORS + 1,
+                        rand() % NUM_FLOORS + 1, ii,
+                        run->priorities ? rand() % NUM_PRIORITIES : 0);
+            }
+            check->numRequests[ii] = count;
+        }
+        fclose(file);
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        runSim
+ *
+ * PURPOSE:     Run a sim on the input file with CSV output, kill it if it
+ *              doesn't finish in time, then check its logs.
+ *
+ * IMPORT:      exe - path of lift_sim_A or lift_sim_B
+ *              run - the settings
+ *              check - what the logs must show (reason set on failure)
+ * EXPORT:      Error code (-1 = the run failed)
+ * ***************************************************************************/
+static int runSim(const char* exe, const StressRun* run, StressCheck* check)
+{
+    int status = 0, exitStatus = 0;
+    char buffer[16], delay[16], lifts[16], producers[16], travel[48];
+
+    snprintf(buffer, sizeof(buffer), "%d", run->bufferSize);
+    snprintf(delay, sizeof(delay), "%.3f", run->delayMs / 1000.0);
+    snprintf(lifts, sizeof(lifts), "%d", run->numLifts);
+    snprintf(producers, sizeof(producers), "%d", 
+             run->implB ? 1 : run->numProducers);
+    snprintf(travel, sizeof(travel), "%d,%d,%d", run->travel.floorMs,
+             run->travel.accelMs, run->travel.doorMs);
+    char* args[] = { (char*)exe, buffer, delay, "input.csv", "--lifts", lifts,
+                     "--producers", producers, "--output", "csv", "--quiet", 
+                     "--output-backend", 
+                     (run->batch && !run->implB) ? "batch" : "stdio",
+                     "--travel", travel,
+                     run->travel.virtualTime ? "--virtual" : NULL, NULL };
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // Own process group, so B's lifts can be killed along with it
+        setpgid(0, 0);
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        execv(exe, args);
+        _exit(127);
+    }
+
+    int waited = 0;
+    while (waitpid(pid, &exitStatus, WNOHANG) == 0)
+    {
+        if (waited >= STRESS_TIMEOUT_MS)
+        {
+            kill(-pid, SIGKILL);
+            waitpid(pid, &exitStatus, 0);
+            snprintf(check->reason, sizeof(check->reason),
+                     "still running after %d ms", STRESS_TIMEOUT_MS);
+            status = -1;
+        }
+        else
+        {
+            sleepMs(1);
+            waited++;
+        }
+    }
+
+    if (status == 0 && (!WIFEXITED(exitStatus) ||
+                        WEXITSTATUS(exitStatus) != 0))
+    {
+        snprintf(check->reason, sizeof(check->reason), "exited with status "
+                 "%d", WIFEXITED(exitStatus) ? WEXITSTATUS(exitStatus)
+                                             : -WTERMSIG(exitStatus));
+        status = -1;
+    }
+
+    int numBuildings = run->implB ? 1 : run->numBuildings;
+    for (int ii = 1; ii <= numBuildings && status == 0; ii++)
+    {
+        char path[OUT_NAME_LEN];
+        if (ii == 1)
+        {
+            snprintf(path, sizeof(path), "%s", OUT_FILE);
+        }
+        else
+        {
+            snprintf(path, sizeof(path), OUT_FILE_FMT, ii);
+        }
+        status = checkLog(path, check->numRequests[ii], run, check);
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        checkLog
+ *
+ * PURPOSE:     Check one building's CSV log row by row, then that each of
+ *              its requests was added and served once.
+ *
+ * IMPORT:      path - the log
+ *              numRequests - requests the building was given
+ *              run - the settings
+ *              check - reason set on failure
+ * EXPORT:      Error code (-1 = the log is wrong)
+ * ***************************************************************************/
+static int checkLog(const char* path, int numRequests, const StressRun* run,
+                    StressCheck* check)
+{
+    int status = 0, queued = 0, numAdded = 0, row = 1;
+    char line[256];
+    int liftRequests[STRESS_MAX_LIFTS + 1];
+    int liftMovements[STRESS_MAX_LIFTS + 1];
+    int liftFloor[STRESS_MAX_LIFTS + 1];
+
+    memset(check->added, 0, sizeof(check->added));
+    memset(check->served, 0, sizeof(check->served));
+    for (int ii = 1; ii <= run->numLifts; ii++)
+    {
+        liftRequests[ii] = 0;
+        liftMovements[ii] = 0;
+        liftFloor[ii] = GROUND_FLOOR;
+    }
+
+    FILE* file = fopen(path, "r");
+    if (file == NULL || fgets(line, sizeof(line), file) == NULL)
+    {
+        snprintf(check->reason, sizeof(check->reason), "no log %s", path);
+        status = -1;
+    }
+
+    while (status == 0 && fgets(line, sizeof(line), file) != NULL)
+    {
+        int num, lift, start, dest, prev, moves, requests, total;
+        row++;
+
+        if (sscanf(line, "request,%d,,%d,%d", &num, &start, &dest) == 3)
+        {
+            if (num < 1 || num > numRequests ||
+                check->added[num]++ > 0)
+            {
+                snprintf(check->reason, sizeof(check->reason), "%s row %d: "
+                         "request %d added again", path, row, num);
+                status = -1;
+            }
+            else if (num != ++numAdded)
+            {
+                snprintf(check->reason, sizeof(check->reason), "%s row %d: "
+                         "request %d added as number %d", path, row, num,
+                         numAdded);
+                status = -1;
+            }
+            else if (++queued > run->bufferSize)
+            {
+                snprintf(check->reason, sizeof(check->reason), "%s row %d: "
+                         "%d requests in a buffer of %d", path, row, queued,
+                         run->bufferSize);
+                status = -1;
+            }
+        }
+        else if (sscanf(line, "lift,%d,%d,%d,%d,%d,%d,%d,%d", &num, &lift,
+                        &start, &dest, &prev, &moves, &requests,
+                        &total) == 8)
+        {
+            queued--;
+            if (num < 1 || num > numRequests ||
+                check->added[num] != 1 || check->served[num]++ > 0)
+            {
+                snprintf(check->reason, sizeof(check->reason), "%s row %d: "
+                         "request %d served before being added, or twice",
+                         path, row, num);
+                status = -1;
+            }
+            else if (lift < 1 || lift > run->numLifts ||
+                     requests != liftRequests[lift] + 1 ||
+                     prev != liftFloor[lift] ||
+                     moves != abs(prev - start) + abs(start - dest) ||
+                     total != liftMovements[lift] + moves)
+            {
+                snprintf(check->reason, sizeof(check->reason), "%s row %d: "
+                         "lift %d doesn't follow on from its last request",
+                         path, row, lift);
+                status = -1;
+            }
+            else
+            {
+                liftRequests[lift] = requests;
+                liftMovements[lift] = total;
+                liftFloor[lift] = dest;
+            }
+        }
+        else
+        {
+            snprintf(check->reason, sizeof(check->reason), "%s row %d: "
+                     "can't read '%.40s'", path, row, line);
+            status = -1;
+        }
+    }
+
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    for (int ii = 1; ii <= numRequests && status == 0; ii++)
+    {
+        if (check->added[ii] != 1 || check->served[ii] != 1)
+        {
+            snprintf(check->reason, sizeof(check->reason), "%s: request %d "
+                     "added %d times, served %d times", path, ii,
+                     check->added[ii], check->served[ii]);
+            status = -1;
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,215 @@
+/* ****************************************************************************
+ * FILE:        summary.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Per-lift, per-floor and per-priority totals of a simulation,
+ *              added to as requests are served and written to a small 
+ *              summary file at the end, so analytics never need the output
+ *              log.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "summary.h"
+#include "cache.h"
+
+/* ****************************************************************************
+ * NAME:        summaryBytes
+ * 
+ * PURPOSE:     Returns the size of a summary of numLifts lifts, rounded up to
+ *              whole cache lines (so whatever follows it stays aligned).
+ * 
+ * IMPORT:      numLifts - number of lifts
+ * EXPORT:      Size in bytes
+ * ***************************************************************************/
+size_t summaryBytes(int numLifts)
+{
+    size_t bytes = sizeof(Summary) + sizeof(LiftSummary) * numLifts;
+
+    return (bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+/* ****************************************************************************
+ * NAME:        initSummary
+ * 
+ * PURPOSE:     Zero a summary in memory that is already allocated.
+ * 
+ * IMPORT:      summary - summaryBytes(numLifts) of memory
+ *              numLifts - number of lifts
+ * ***************************************************************************/
+void initSummary(Summary* summary, int numLifts)
+{
+    memset(summary, 0, summaryBytes(numLifts));
+    summary->numLifts = numLifts;
+}
+
+/* ****************************************************************************
+ * NAME:        createSummary
+ * 
+ * PURPOSE:     To generate an empty summary. Released with free().
+ * 
+ * IMPORT:      numLifts - number of lifts
+ * EXPORT:      pointer to the summary
+ * ***************************************************************************/
+Summary* createSummary(int numLifts)
+{
+    Summary* summary = (Summary*)malloc(summaryBytes(numLifts));
+    initSummary(summary, numLifts);
+
+    return summary;
+}
+
+/* ****************************************************************************
+ * NAME:        recordRequest
+ * 
+ * PURPOSE:     Add a served request to the totals. Callers serialise access.
+ * 
+ * IMPORT:      summary - the summary
+ *              lift - index of the lift serving it
+ *              fromFloor - where the lift was before serving it
+ *              req - the request
+ *              waitNs - how long it waited in the buffer
+ * ***************************************************************************/
+void recordRequest(Summary* summary, int lift, int fromFloor, Request* req,
+                   long long waitNs)
+{
+    int empty = abs(fromFloor - req->start);
+    int loaded = abs(req->start - req->destination);
+    LiftSummary* liftSum = &summary->lifts[lift];
+
+    summary->requests++;
+    summary->movements += empty + loaded;
+    summary->pickups[req->start]++;
+    summary->dropoffs[req->destination]++;
+    summary->trips[req->start][req->destination]++;
+
+    liftSum->requests++;
+    liftSum->movements += empty + loaded;
+    liftSum->emptyMovements += empty;
+
+    if (req->priority >= 0 && req->priority < NUM_PRIORITIES)
+    {
+        ClassSummary* classSum = &summary->classes[req->priority];
+        classSum->requests++;
+        classSum->waitNs += waitNs;
+        if (waitNs > classSum->maxWaitNs)
+        {
+            classSum->maxWaitNs = waitNs;
+        }
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        printClassStats
+ * 
+ * PURPOSE:     Print how long the requests of each priority class waited in
+ *              the buffer, for the classes that had any.
+ * 
+ * IMPORT:      summary - the summary
+ * ***************************************************************************/
+void printClassStats(Summary* summary)
+{
+    for (int ii = 0; ii < NUM_PRIORITIES; ii++)
+    {
+        ClassSummary* classSum = &summary->classes[ii];
+        if (classSum->requests > 0)
+        {
+            printf("    Priority %d: %d requests, waited %.3f s on average, "
+                   "%.3f s at most\n", ii, classSum->requests, 
+                   classSum->waitNs / 1e9 / classSum->requests,
+                   classSum->maxWaitNs / 1e9);
+        }
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        writeSummary
+ * 
+ * PURPOSE:     Write the summaries of every building to a file, as CSV 
+ *              sections: totals, one row per lift, one row per floor, then 
+ *              the origin/destination matrix (a row per origin floor, a 
+ *              column per destination floor).
+ * 
+ * IMPORT:      path - file to write
+ *              summaries - building n's summary at index n - 1
+ *              numSummaries - length of the array
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int writeSummary(const char* path, Summary** summaries, int numSummaries)
+{
+    int status = 0;
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+    {
+        perror("there was an error opening the summary file");
+        status = -1;
+    }
+    else
+    {
+        for (int ii = 0; ii < numSummaries; ii++)
+        {
+            Summary* summary = summaries[ii];
+
+            fprintf(file, "building,%d\n", ii + 1);
+            fprintf(file, "requests,%d\n", summary->requests);
+            fprintf(file, "movements,%d\n", summary->movements);
+
+            fprintf(file, "lift,requests,movements,empty_movements\n");
+            for (int jj = 0; jj < summary->numLifts; jj++)
+            {
+                fprintf(file, "%d,%d,%d,%d\n", jj + 1, 
+                        summary->lifts[jj].requests, 
+                        summary->lifts[jj].movements,
+                        summary->lifts[jj].emptyMovements);
+            }
+
+            fprintf(file, "priority,requests,mean_wait_ms,max_wait_ms\n");
+            for (int jj = 0; jj < NUM_PRIORITIES; jj++)
+            {
+                ClassSummary* classSum = &summary->classes[jj];
+                fprintf(file, "%d,%d,%.3f,%.3f\n", jj, classSum->requests,
+                        classSum->requests > 0 ? 
+                            classSum->waitNs / 1e6 / classSum->requests : 0.0,
+                        classSum->maxWaitNs / 1e6);
+            }
+
+            fprintf(file, "floor,pickups,dropoffs\n");
+            for (int jj = GROUND_FLOOR; jj <= NUM_FLOORS; jj++)
+            {
+                fprintf(file, "%d,%d,%d\n", jj, summary->pickups[jj],
+                        summary->dropoffs[jj]);
+            }
+
+            fprintf(file, "from\\to");
+            for (int jj = GROUND_FLOOR; jj <= NUM_FLOORS; jj++)
+            {
+                fprintf(file, ",%d", jj);
+            }
+            fprintf(file, "\n");
+            for (int jj = GROUND_FLOOR; jj <= NUM_FLOORS; jj++)
+            {
+                fprintf(file, "%d", jj);
+                for (int kk = GROUND_FLOOR; kk <= NUM_FLOORS; kk++)
+                {
+                    fprintf(file, ",%d", summary->trips[jj][kk]);
+                }
+                fprintf(file, "\n");
+            }
+            fprintf(file, "\n");
+        }
+
+        // Final error check
+        if (ferror(file))
+        {
+            perror("there was an error writing the summary file");
+            status = -1;
+        }
+        fclose(file);
+    }
+
+    return status;
+}
@@ -0,0 +1,62 @@
+/* ****************************************************************************
+ * FILE:        summary.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for summary.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stddef.h>
+#include "lift_sim.h"
+#include "linked_list.h"
+
+#ifndef SUMMARY
+#define SUMMARY
+
+#define SUMMARY_FILE "sim_summary.csv" // used by --output summary
+
+// Totals of one lift
+// emptyMovements = floors travelled to pick someone up (the rest are loaded)
+typedef struct LiftSummary
+{
+    int requests;
+    int movements;
+    int emptyMovements;
+} LiftSummary;
+
+// Totals of one priority class
+// waitNs / maxWaitNs = time its requests waited in the buffer, summed / worst
+typedef struct ClassSummary
+{
+    int requests;
+    long long waitNs;
+    long long maxWaitNs;
+} ClassSummary;
+
+// Running totals of a building, kept up to date as every request is served
+// (under the lock the lift already holds) so nothing has to be worked out 
+// from the output file afterwards. Floors are indexed by floor number.
+// trips[from][to] = requests from floor 'from' to floor 'to'
+typedef struct Summary
+{
+    int numLifts;
+    int requests;
+    int movements;
+    int pickups[NUM_FLOORS + 1];
+    int dropoffs[NUM_FLOORS + 1];
+    int trips[NUM_FLOORS + 1][NUM_FLOORS + 1];
+    ClassSummary classes[NUM_PRIORITIES];
+    LiftSummary lifts[];
+} Summary;
+
+#endif
+
+// Prototype Declarations
+size_t summaryBytes(int numLifts);
+void initSummary(Summary* summary, int numLifts);
+Summary* createSummary(int numLifts);
+void recordRequest(Summary* summary, int lift, int fromFloor, Request* req,
+                   long long waitNs);
+void printClassStats(Summary* summary);
+int writeSummary(const char* path, Summary** summaries, int numSummaries);
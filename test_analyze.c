@@ -0,0 +1,113 @@
+/* ****************************************************************************
+ * FILE:        test_analyze.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Test harness for analyze.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "analyze.h"
+
+int main(int argc, char *argv[])
+{
+    // An odd count, so the vector kernels leave some to the scalar code
+    const int count = 200003;
+    int* start = (int*)malloc(sizeof(int) * count);
+    int* dest = (int*)malloc(sizeof(int) * count);
+    TraceStats expected, actual;
+    const char* name = NULL;
+
+    srand(1);
+    for (int ii = 0; ii < count; ii++)
+    {
+        start[ii] = rand() % (NUM_FLOORS + 4) - 1; // some out of range
+        dest[ii] = (ii % 7 == 0) ? start[ii] : rand() % (NUM_FLOORS + 1) + 1;
+    }
+
+    // SCALAR
+    printf("*****************\n");
+    printf("| Scalar Kernel |\n");
+    printf("*****************\n");
+
+    printf("analyzeScalar(): ");
+    memset(&expected, 0, sizeof(expected));
+    analyzeScalar(start, dest, count, &expected);
+
+    long long floors = 0;
+    for (int ii = GROUND_FLOOR; ii <= NUM_FLOORS; ii++)
+    {
+        floors += expected.pickups[ii];
+    }
+
+    if (expected.requests != count || expected.invalid == 0 || 
+        expected.sameFloor == 0 || floors != count - expected.invalid ||
+        expected.up + expected.down + expected.sameFloor != floors)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // VECTOR
+    printf("\n******************\n");
+    printf("| Vector Kernels |\n");
+    printf("******************\n");
+
+#if defined(__x86_64__) || defined(__i386__)
+    printf("analyzeSse2(): ");
+    memset(&actual, 0, sizeof(actual));
+    analyzeSse2(start, dest, count, &actual);
+    if (memcmp(&expected, &actual, sizeof(TraceStats)) != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    printf("analyzeAvx2(): ");
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        memset(&actual, 0, sizeof(actual));
+        analyzeAvx2(start, dest, count, &actual);
+        if (memcmp(&expected, &actual, sizeof(TraceStats)) != 0)
+        {
+            printf("FAILED\n");
+        }
+        else
+        {
+            printf("PASSED\n");
+        }
+    }
+    else
+    {
+        printf("PASSED (no AVX2 on this CPU)\n");
+    }
+#endif
+
+    printf("chooseKernel(): ");
+    AnalyzeKernel kernel = chooseKernel(&name);
+    memset(&actual, 0, sizeof(actual));
+    kernel(start, dest, count, &actual);
+    if (name == NULL || memcmp(&expected, &actual, sizeof(TraceStats)) != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    free(start);
+    free(dest);
+
+    return 0;
+}
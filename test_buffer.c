@@ -146,6 +146,53 @@ int main(int argc, char const *argv[])
         printf("PASSED\n");
     }
 
+    // WRAPPING
+    printf("\n************\n");
+    printf("| Wrapping |\n");
+    printf("************\n");
+
+    // keep going round, past the 8 slots behind a capacity of 5
+    printf("addToBuffer() 3: ");
+    int status = 0;
+    for (int ii = 0; ii < 4 * bufferSize; ii++)
+    {
+        if (addToBuffer(buf, requests[ii % bufferSize]) != 0 ||
+            addToBuffer(buf, requests[(ii + 1) % bufferSize]) != 0 ||
+            popBuffer(buf) != requests[ii % bufferSize] ||
+            popBuffer(buf) != requests[(ii + 1) % bufferSize])
+        {
+            status = -1;
+        }
+    }
+
+    if (status != 0 || isEmpty(buf) != 1 || popBuffer(buf) != NULL)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // a full buffer refuses, and keeps what it has
+    printf("addToBuffer() 4: ");
+    for (int ii = 0; ii < bufferSize; ii++)
+    {
+        addToBuffer(buf, requests[ii]);
+    }
+
+    if (addToBuffer(buf, requests[0]) != -1 || isFull(buf) != 1 ||
+        popBuffer(buf) != requests[0])
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    while (popBuffer(buf) != NULL);
+
     // FREEING
     printf("\n***********\n");
     printf("| Freeing |\n");
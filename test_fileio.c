@@ -0,0 +1,350 @@
+/* ****************************************************************************
+ * FILE:        test_fileio.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Test harness for fileio.c, mostly the chunked parallel parse
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fileio.h"
+
+#define TEST_INPUT "test_fileio.in"
+#define TEST_TRACE "test_fileio.trace"
+#define TEST_ERRORS "test_fileio.out"
+#define NUM_LINES 3001
+#define MAX_FLOOR 20
+
+static int writeInput(const char* path, int* badLines, int* numBad);
+static int parse(int numChunks, LinkedList* list, char** errors);
+static int checkLines(const char* errors, const int* badLines, int numBad);
+static int sameRequests(LinkedList* list, LinkedList* other);
+static int checkTrace(void);
+
+int main(int argc, char *argv[])
+{
+    // several ways to split the file, down to chunks of a few lines
+    const int chunkCounts[] = { 2, 3, 7, 64 };
+    int* badLines = (int*)malloc(sizeof(int) * NUM_LINES);
+    int numBad = 0, numValid = 0;
+    LinkedList* single = createLinkedList();
+    char* singleErrors = NULL;
+    char name[64];
+
+    numValid = writeInput(TEST_INPUT, badLines, &numBad);
+
+    // ONE CHUNK
+    printf("*************\n");
+    printf("| One Chunk |\n");
+    printf("*************\n");
+
+    printf("readRequestsChunked(1): ");
+    if (parse(1, single, &singleErrors) != 0 || single->size != numValid ||
+        single->tail->req->num != numValid ||
+        single->tail->req->start != 5 || single->tail->req->destination != 9)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    printf("readRequestsChunked(1) error lines: ");
+    if (checkLines(singleErrors, badLines, numBad) != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // MANY CHUNKS
+    printf("\n***************\n");
+    printf("| Many Chunks |\n");
+    printf("***************\n");
+
+    for (int ii = 0; ii < (int)(sizeof(chunkCounts) / sizeof(int)); ii++)
+    {
+        LinkedList* list = createLinkedList();
+        char* errors = NULL;
+
+        sprintf(name, "readRequestsChunked(%d)", chunkCounts[ii]);
+        printf("%s: ", name);
+        if (parse(chunkCounts[ii], list, &errors) != 0 ||
+            sameRequests(single, list) != 0)
+        {
+            printf("FAILED\n");
+        }
+        else
+        {
+            printf("PASSED\n");
+        }
+
+        printf("%s error lines: ", name);
+        if (errors == NULL || strcmp(errors, singleErrors) != 0)
+        {
+            printf("FAILED\n");
+        }
+        else
+        {
+            printf("PASSED\n");
+        }
+
+        freeLinkedList(list);
+        free(errors);
+    }
+
+    // RAW PARSE
+    printf("\n*************\n");
+    printf("| Raw Parse |\n");
+    printf("*************\n");
+
+    printf("readTrace(): ");
+    if (checkTrace() != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    freeLinkedList(single);
+    free(singleErrors);
+    free(badLines);
+    remove(TEST_INPUT);
+    remove(TEST_ERRORS);
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        writeInput
+ *
+ * PURPOSE:     Write NUM_LINES lines of requests, with blank lines and every
+ *              kind of invalid line mixed in, and no newline after the last
+ *              (valid) line "5 9".
+ *
+ * IMPORT:      path - file to write
+ *              badLines - filled with the line numbers of the invalid lines
+ *              numBad - set to the number of invalid lines
+ * EXPORT:      Number of valid requests written
+ * ***************************************************************************/
+static int writeInput(const char* path, int* badLines, int* numBad)
+{
+    int numValid = 0;
+
+    *numBad = 0;
+    FILE* file = fopen(path, "w");
+    for (int line = 1; line < NUM_LINES; line++)
+    {
+        int bad = TRUE;
+        if (line % 53 == 0)
+        {
+            fprintf(file, "0 4\n");
+        }
+        else if (line % 71 == 0)
+        {
+            fprintf(file, "3 %d\n", MAX_FLOOR + 1);
+        }
+        else if (line % 89 == 0)
+        {
+            fprintf(file, "2 3 0\n");
+        }
+        else if (line % 97 == 0)
+        {
+            fprintf(file, "2 3 1 %d\n", NUM_PRIORITIES);
+        }
+        else if (line % 61 == 0)
+        {
+            fprintf(file, "\n");
+            bad = FALSE;
+        }
+        else
+        {
+            fprintf(file, "%d %d %d %d\n", line % MAX_FLOOR + 1,
+                    (line * 7) % MAX_FLOOR + 1, line % 3 + 1,
+                    line % NUM_PRIORITIES);
+            bad = FALSE;
+            numValid++;
+        }
+
+        if (bad)
+        {
+            badLines[(*numBad)++] = line;
+        }
+    }
+    fprintf(file, "5 9");
+    fclose(file);
+
+    return numValid + 1;
+}
+
+/* ****************************************************************************
+ * NAME:        parse
+ *
+ * PURPOSE:     Parse the test input in a given number of chunks, catching
+ *              the invalid line reports printed to stdout.
+ *
+ * IMPORT:      numChunks - chunks to split the file into
+ *              list - list to house the requests
+ *              errors - set to the reports printed (malloc'd)
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+static int parse(int numChunks, LinkedList* list, char** errors)
+{
+    int status = 0;
+
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    if (freopen(TEST_ERRORS, "w", stdout) == NULL)
+    {
+        status = -1;
+    }
+    else
+    {
+        status = readRequestsChunked(TEST_INPUT, list, 1, MAX_FLOOR,
+                                     numChunks);
+        fflush(stdout);
+    }
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    FILE* file = fopen(TEST_ERRORS, "r");
+    if (file == NULL)
+    {
+        status = -1;
+    }
+    else
+    {
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        *errors = (char*)malloc(size + 1);
+        (*errors)[fread(*errors, 1, size, file)] = '\0';
+        fclose(file);
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        checkLines
+ *
+ * PURPOSE:     Check the invalid line reports name exactly the invalid
+ *              lines, in order.
+ *
+ * EXPORT:      Error code (-1 = a line is missing, extra or out of order)
+ * ***************************************************************************/
+static int checkLines(const char* errors, const int* badLines, int numBad)
+{
+    int status = 0, count = 0, line = 0;
+    const char* pos = errors;
+
+    while (status == 0 && pos != NULL && *pos != '\0')
+    {
+        if (sscanf(pos, "error in " TEST_INPUT " at line %d:", &line) != 1 ||
+            count >= numBad || line != badLines[count])
+        {
+            status = -1;
+        }
+        count++;
+
+        pos = strchr(pos, '\n');
+        if (pos != NULL)
+        {
+            pos++;
+        }
+    }
+
+    return (count == numBad) ? status : -1;
+}
+
+/* ****************************************************************************
+ * NAME:        sameRequests
+ *
+ * PURPOSE:     Check two lists hold the same requests, numbered the same.
+ *
+ * EXPORT:      Error code (-1 = the lists differ)
+ * ***************************************************************************/
+static int sameRequests(LinkedList* list, LinkedList* other)
+{
+    int status = (list->size == other->size) ? 0 : -1;
+    RequestNode* node = list->head;
+    RequestNode* otherNode = other->head;
+
+    while (status == 0 && node != NULL && otherNode != NULL)
+    {
+        Request* req = node->req;
+        Request* otherReq = otherNode->req;
+        if (req->num != otherReq->num || req->start != otherReq->start ||
+            req->destination != otherReq->destination ||
+            req->building != otherReq->building ||
+            req->priority != otherReq->priority)
+        {
+            status = -1;
+        }
+        node = node->next;
+        otherNode = otherNode->next;
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        checkTrace
+ *
+ * PURPOSE:     Check readTrace keeps requests whatever their floors, 
+ *              building and priority, and only drops a line missing a floor.
+ *
+ * EXPORT:      Error code (-1 = a request was dropped or changed)
+ * ***************************************************************************/
+static int checkTrace(void)
+{
+    const int starts[] = { 0, -3, 25, 3, 5 };
+    const int dests[] = { 5, 4, 2, 4, 5 };
+    int status = 0, ii = 0;
+    LinkedList* list = createLinkedList();
+
+    FILE* file = fopen(TEST_TRACE, "w");
+    fprintf(file, "0 5\n-3 4\n25 2\n3 4 0 9\n7\n\n5 5");
+    fclose(file);
+
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    if (freopen(TEST_ERRORS, "w", stdout) == NULL ||
+        readTrace(TEST_TRACE, list) != 0)
+    {
+        status = -1;
+    }
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    if (list->size != 5)
+    {
+        status = -1;
+    }
+    for (RequestNode* node = list->head; node != NULL && status == 0; 
+         node = node->next)
+    {
+        if (node->req->num != ii + 1 || node->req->start != starts[ii] ||
+            node->req->destination != dests[ii])
+        {
+            status = -1;
+        }
+        ii++;
+    }
+
+    freeLinkedList(list);
+    remove(TEST_TRACE);
+
+    return status;
+}
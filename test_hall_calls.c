@@ -0,0 +1,206 @@
+/* ****************************************************************************
+ * FILE:        test_hall_calls.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Test harness for hall_calls.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "hall_calls.h"
+#include "linked_list.h"
+
+int main(int argc, char *argv[])
+{
+    const int numFloors = 200;
+    HallCalls* calls = NULL;
+    Request requests[8];
+
+    // up from 3, 70 and 130 (twice), down from 5 and 128 (twice)
+    int starts[] = { 3, 70, 130, 130, 5, 128, 128, 300 };
+    int dests[] = { 9, 71, 199, 140, 1, 2, 64, 1 };
+    for (int ii = 0; ii < 8; ii++)
+    {
+        requests[ii].num = ii + 1;
+        requests[ii].start = starts[ii];
+        requests[ii].destination = dests[ii];
+        requests[ii].building = 1;
+        requests[ii].priority = 0;
+        requests[ii].queuedNs = 0;
+    }
+
+    // CREATING
+    printf("***********************\n");
+    printf("| Creating Hall Calls |\n");
+    printf("***********************\n");
+
+    printf("createHallCalls(0): ");
+    calls = createHallCalls(0);
+    if (calls != NULL)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    printf("createHallCalls(200): ");
+    calls = createHallCalls(numFloors);
+    if (calls == NULL || calls->size != 0 ||
+        nearestCall(calls, 1, CALL_UP) != -1 ||
+        nearestCall(calls, numFloors, CALL_DOWN) != -1 ||
+        takeCall(calls, 1, CALL_UP) != NULL)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // ADDING
+    printf("\n**********\n");
+    printf("| Adding |\n");
+    printf("**********\n");
+
+    printf("addCall(): ");
+    int status = 0;
+    for (int ii = 0; ii < 7; ii++)
+    {
+        if (addCall(calls, &requests[ii]) != 0)
+        {
+            status = -1;
+        }
+    }
+    if (status != 0 || addCall(calls, &requests[7]) != -1 ||
+        calls->size != 7 || callDirection(&requests[0]) != CALL_UP ||
+        callDirection(&requests[4]) != CALL_DOWN)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // FINDING
+    printf("\n***********\n");
+    printf("| Finding |\n");
+    printf("***********\n");
+
+    // on the floor itself, in the same word and across words
+    printf("nearestCall() up: ");
+    if (nearestCall(calls, 3, CALL_UP) != 3 ||
+        nearestCall(calls, 4, CALL_UP) != 70 ||
+        nearestCall(calls, 64, CALL_UP) != 70 ||
+        nearestCall(calls, 71, CALL_UP) != 130 ||
+        nearestCall(calls, 131, CALL_UP) != -1 ||
+        nearestCall(calls, 0, CALL_UP) != 3)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    printf("nearestCall() down: ");
+    if (nearestCall(calls, numFloors, CALL_DOWN) != 128 ||
+        nearestCall(calls, 128, CALL_DOWN) != 128 ||
+        nearestCall(calls, 127, CALL_DOWN) != 5 ||
+        nearestCall(calls, 63, CALL_DOWN) != 5 ||
+        nearestCall(calls, 4, CALL_DOWN) != -1 ||
+        nearestCall(calls, numFloors + 1, CALL_DOWN) != -1)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // REMOVING
+    printf("\n************\n");
+    printf("| Removing |\n");
+    printf("************\n");
+
+    // oldest first, and the floor is only cleared once it has no calls
+    printf("takeCall(): ");
+    Request* first = takeCall(calls, 130, CALL_UP);
+    int stillWaiting = nearestCall(calls, 71, CALL_UP);
+    Request* second = takeCall(calls, 130, CALL_UP);
+    if (first != &requests[2] || stillWaiting != 130 ||
+        second != &requests[3] || takeCall(calls, 130, CALL_UP) != NULL ||
+        nearestCall(calls, 71, CALL_UP) != -1 || calls->size != 5)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    printf("removeCall(): ");
+    if (removeCall(calls, &requests[5]) != 0 ||
+        removeCall(calls, &requests[5]) != -1 ||
+        nearestCall(calls, 200, CALL_DOWN) != 128 ||
+        takeCall(calls, 128, CALL_DOWN) != &requests[6] ||
+        nearestCall(calls, 200, CALL_DOWN) != 5 || calls->size != 3)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // a floor's queue wraps round and grows, and still gives its calls
+    // back oldest first, with one taken out of the middle
+    printf("removeCall() wrapped queue: ");
+    Request waiting[12];
+    for (int ii = 0; ii < 12; ii++)
+    {
+        waiting[ii] = requests[0];
+        waiting[ii].num = 100 + ii;
+        waiting[ii].start = 20;
+        waiting[ii].destination = 30;
+    }
+    status = 0;
+    for (int ii = 0; ii < 3; ii++)
+    {
+        addCall(calls, &waiting[ii]);
+    }
+    takeCall(calls, 20, CALL_UP);
+    takeCall(calls, 20, CALL_UP);
+    for (int ii = 3; ii < 12; ii++)
+    {
+        addCall(calls, &waiting[ii]);
+    }
+    if (removeCall(calls, &waiting[7]) != 0)
+    {
+        status = -1;
+    }
+    for (int ii = 2; ii < 12; ii++)
+    {
+        if (ii != 7 && takeCall(calls, 20, CALL_UP) != &waiting[ii])
+        {
+            status = -1;
+        }
+    }
+    if (status != 0 || takeCall(calls, 20, CALL_UP) != NULL ||
+        calls->size != 3)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    freeHallCalls(calls);
+
+    return 0;
+}
@@ -141,6 +141,47 @@ int main(int argc, char const *argv[])
        printf("FAILED\n");
     }
 
+    // APPENDING
+    printf("\n***************\n");
+    printf("| Append List |\n");
+    printf("***************\n");
+
+    // (1) onto an empty list, (2) onto a list with nodes in it
+    LinkedList* other = createLinkedList();
+    insertLast(other, requests[0]);
+    insertLast(other, requests[1]);
+
+    printf("appendList() 1: ");
+    appendList(list, other);
+    if(list->size == 2 && list->head->req == requests[0] && 
+       list->tail->req == requests[1] && other->size == 0 && 
+       other->head == NULL)
+    {
+       printf("PASSED\n");
+    }
+    else
+    {
+       printf("FAILED\n");
+    }
+
+    insertLast(other, requests[2]);
+    printf("appendList() 2: ");
+    appendList(list, other);
+    if(list->size == 3 && list->head->next->next->req == requests[2] && 
+       list->tail->req == requests[2] && other->tail == NULL)
+    {
+       printf("PASSED\n");
+    }
+    else
+    {
+       printf("FAILED\n");
+    }
+
+    removeStart(list);
+    removeStart(list);
+    removeStart(list);
+    free(other);
+
     // FREEING
     printf("\n***********\n");
     printf("| Freeing |\n");
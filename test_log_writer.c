@@ -0,0 +1,189 @@
+/* ****************************************************************************
+ * FILE:        test_log_writer.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Test harness for log_writer.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "log_writer.h"
+
+#define TEST_LOG "test_log_writer.out"
+
+static long fileSize(const char* path);
+static int checkFile(const char* path, int numLines);
+
+int main(int argc, char *argv[])
+{
+    // enough lines to fill every page several times over
+    const int numLines = (LOG_PAGE * LOG_PAGES * 3) / 16;
+    LogWriter* log = NULL;
+    char line[32];
+
+    remove(TEST_LOG);
+
+    // OPENING
+    printf("***************\n");
+    printf("| Opening Log |\n");
+    printf("***************\n");
+
+    printf("openLog() bad path: ");
+    log = openLog("no_such_dir/" TEST_LOG);
+    if (log != NULL)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    printf("openLog(): ");
+    log = openLog(TEST_LOG);
+    if (log == NULL || strcmp(log->path, TEST_LOG) != 0 || log->bytes != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // APPENDING
+    printf("\n*************\n");
+    printf("| Appending |\n");
+    printf("*************\n");
+
+    // a partial page stays in memory until flushed
+    printf("appendLog() one line: ");
+    int len = snprintf(line, sizeof(line), "line %09d\n", 0);
+    if (appendLog(log, line, len) != 0 || fileSize(TEST_LOG) != 0 ||
+        flushLog(log) != 0 || fileSize(TEST_LOG) != len)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // lines split over pages come out whole and in order
+    printf("appendLog() many pages: ");
+    int status = 0;
+    for (int ii = 1; ii < numLines; ii++)
+    {
+        len = snprintf(line, sizeof(line), "line %09d\n", ii);
+        if (appendLog(log, line, len) != 0)
+        {
+            status = -1;
+        }
+    }
+    if (status != 0 || flushLog(log) != 0 ||
+        fileSize(TEST_LOG) != (long)numLines * len ||
+        log->bytes != (long long)numLines * len ||
+        checkFile(TEST_LOG, numLines) != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // an event rendered in place is only logged once committed
+    printf("reserveLog() / commitLog(): ");
+    char* room = reserveLog(log, sizeof(line));
+    len = snprintf(room, sizeof(line), "line %09d\n", numLines);
+    if (log->bytes != (long long)numLines * len ||
+        commitLog(log, len) != 0 || flushLog(log) != 0 ||
+        checkFile(TEST_LOG, numLines + 1) != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // CLOSING
+    printf("\n***********\n");
+    printf("| Closing |\n");
+    printf("***********\n");
+
+    // closing writes what is left, reopening appends after it
+    printf("closeLog(): ");
+    log = openLog(TEST_LOG);
+    len = snprintf(line, sizeof(line), "line %09d\n", numLines + 1);
+    appendLog(log, line, len);
+    if (closeLog(log) != 0 ||
+        fileSize(TEST_LOG) != (long)(numLines + 2) * len ||
+        checkFile(TEST_LOG, numLines + 2) != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    remove(TEST_LOG);
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        fileSize
+ *
+ * PURPOSE:     Size of a file in bytes (-1 if it can't be opened).
+ * ***************************************************************************/
+static long fileSize(const char* path)
+{
+    long size = -1;
+
+    FILE* file = fopen(path, "r");
+    if (file != NULL)
+    {
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fclose(file);
+    }
+
+    return size;
+}
+
+/* ****************************************************************************
+ * NAME:        checkFile
+ *
+ * PURPOSE:     Check a file holds "line n" for n = 0 to numLines - 1, in
+ *              order.
+ *
+ * EXPORT:      Error code (-1 = a line is missing or out of order)
+ * ***************************************************************************/
+static int checkFile(const char* path, int numLines)
+{
+    int status = 0, num = 0, count = 0;
+
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        status = -1;
+    }
+    else
+    {
+        while (status == 0 && fscanf(file, "line %d\n", &num) == 1)
+        {
+            if (num != count)
+            {
+                status = -1;
+            }
+            count++;
+        }
+        fclose(file);
+    }
+
+    return (count == numLines) ? status : -1;
+}
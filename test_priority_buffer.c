@@ -0,0 +1,249 @@
+/* ****************************************************************************
+ * FILE:        test_priority_buffer.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Test harness for priority_buffer.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "priority_buffer.h"
+#include "linked_list.h"
+
+int main(int argc, char *argv[])
+{
+    const int bufferSize = 6;
+    PriorityBuffer* pbuf = NULL;
+    Request* data;
+    Request requests[12];
+    for (int ii = 0; ii < 12; ii++)
+    {
+        requests[ii].num = ii + 1;
+        requests[ii].start = ii % 20 + 1;
+        requests[ii].destination = 1;
+        requests[ii].building = 1;
+        requests[ii].priority = 0;
+        requests[ii].queuedNs = 0;
+    }
+
+    // CREATING
+    printf("****************************\n");
+    printf("| Creating Priority Buffer |\n");
+    printf("****************************\n");
+
+    printf("createPriorityBuffer(0): ");
+    pbuf = createPriorityBuffer(0, 0);
+    if (pbuf != NULL)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    printf("createPriorityBuffer(BUFFER_MAX_SIZE + 1): ");
+    pbuf = createPriorityBuffer(BUFFER_MAX_SIZE + 1, 0);
+    if (pbuf != NULL)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    printf("createPriorityBuffer(6): ");
+    pbuf = createPriorityBuffer(bufferSize, 0);
+    if (pbuf == NULL || isPriorityEmpty(pbuf) != 1 || pbuf->calls != NULL ||
+        isPriorityFull(pbuf) != 0 || pbuf->capacity != bufferSize ||
+        popPriorityBuffer(pbuf) != NULL)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // ORDERING
+    printf("\n************\n");
+    printf("| Ordering |\n");
+    printf("************\n");
+
+    // one capacity shared by every class
+    printf("addToPriorityBuffer(): ");
+    requests[1].priority = 2;
+    requests[2].priority = 1;
+    requests[4].priority = 2;
+    for (int ii = 0; ii < 6; ii++)
+    {
+        addToPriorityBuffer(pbuf, &requests[ii]);
+    }
+    addToPriorityBuffer(pbuf, &requests[6]); // no room
+
+    if (isPriorityFull(pbuf) != 1 || pbuf->size != 6 ||
+        pbuf->counts[0] != 3 || pbuf->counts[1] != 1 || pbuf->counts[2] != 2)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // most urgent first, in order within a class
+    printf("popPriorityBuffer() 1: ");
+    int expected[] = { 2, 5, 3, 1, 4, 6 };
+    int status = 0;
+    for (int ii = 0; ii < 6; ii++)
+    {
+        data = popPriorityBuffer(pbuf);
+        if (data == NULL || data->num != expected[ii])
+        {
+            status = -1;
+        }
+    }
+
+    if (status != 0 || isPriorityEmpty(pbuf) != 1)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // AGING
+    printf("\n*********\n");
+    printf("| Aging |\n");
+    printf("*********\n");
+
+    // a steady stream of urgent requests still lets normal traffic through
+    printf("popPriorityBuffer() 2: ");
+    requests[0].priority = 0;
+    addToPriorityBuffer(pbuf, &requests[0]);
+    int popped = 0;
+    status = -1;
+    for (int ii = 1; ii < 12 && status != 0; ii++)
+    {
+        requests[ii].priority = 2;
+        addToPriorityBuffer(pbuf, &requests[ii]);
+        data = popPriorityBuffer(pbuf);
+        popped++;
+        if (data == &requests[0])
+        {
+            status = 0;
+        }
+    }
+
+    if (status != 0 || popped != PRIORITY_AGING + 1)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // COPYING
+    printf("\n***********\n");
+    printf("| Copying |\n");
+    printf("***********\n");
+
+    printf("copyPriorityBuffer(): ");
+    Request copies[6];
+    while (popPriorityBuffer(pbuf) != NULL);
+    requests[7].priority = 0;
+    requests[8].priority = 1;
+    addToPriorityBuffer(pbuf, &requests[7]);
+    addToPriorityBuffer(pbuf, &requests[8]);
+    if (copyPriorityBuffer(pbuf, copies) != 2 || copies[0].num != 8 ||
+        copies[1].num != 9 || pbuf->size != 2)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // the requests are on the stack, so empty it before freeing
+    while (popPriorityBuffer(pbuf) != NULL);
+    freePriorityBuffer(pbuf);
+
+    // NEAREST CALL
+    printf("\n****************\n");
+    printf("| Nearest Call |\n");
+    printf("****************\n");
+
+    printf("createPriorityBuffer(6, by floor): ");
+    pbuf = createPriorityBuffer(bufferSize, 1);
+    if (pbuf == NULL || pbuf->calls == NULL || isPriorityEmpty(pbuf) != 1 ||
+        popNearest(pbuf, 1, CALL_UP) != NULL)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // normal traffic by floor, urgent traffic still in its own class
+    printf("addToPriorityBuffer() by floor: ");
+    int starts[] = { 3, 9, 12, 5, 7, 9 };
+    int dests[] = { 8, 2, 15, 1, 10, 14 };
+    for (int ii = 0; ii < 6; ii++)
+    {
+        requests[ii].start = starts[ii];
+        requests[ii].destination = dests[ii];
+        requests[ii].priority = (ii == 4) ? 1 : 0;
+        addToPriorityBuffer(pbuf, &requests[ii]);
+    }
+    if (isPriorityFull(pbuf) != 1 || pbuf->calls->size != 5 ||
+        pbuf->counts[0] != 5 || pbuf->counts[1] != 1 ||
+        copyPriorityBuffer(pbuf, copies) != 6 || copies[0].num != 5)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // a lift on 4 going up: the urgent call (to 10), the up call ahead on
+    // 12, then it turns at the furthest down call (9 to 2), turns again at
+    // the furthest up call (3), takes the up call ahead on 9, and lastly 
+    // the down call on 5
+    printf("popNearest(): ");
+    int nearest[] = { 5, 3, 2, 1, 6, 4 };
+    int floor = 4, dir = CALL_UP;
+    status = 0;
+    for (int ii = 0; ii < 6; ii++)
+    {
+        data = popNearest(pbuf, floor, dir);
+        if (data == NULL || data->num != nearest[ii])
+        {
+            status = -1;
+        }
+        else
+        {
+            floor = data->destination;
+            dir = callDirection(data);
+        }
+    }
+    if (status != 0 || isPriorityEmpty(pbuf) != 1 || pbuf->calls->size != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    freePriorityBuffer(pbuf);
+
+    return 0;
+}
@@ -0,0 +1,240 @@
+/* ****************************************************************************
+ * FILE:        test_render.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Test harness for render.c. Besides single entries, every
+ *              entry of the sample logs (sample_files/sim_out*_A.csv) is
+ *              read back into a request / lift and rendered again, and must
+ *              come out byte for byte the same.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "render.h"
+
+#define NUM_GOLDEN 3
+#define GOLDEN_FMT "sample_files/sim_out%d_A.csv"
+
+static int checkGolden(const char* path, int* numEntries);
+static char* readFile(const char* path, long* size);
+
+int main(int argc, char *argv[])
+{
+    char text[EVENT_LEN], expected[EVENT_LEN];
+    Request req = { 7, 3, 12, 1, 0, 0 };
+    Lift lift;
+    memset(&lift, 0, sizeof(Lift));
+    lift.id = 2;
+    lift.currFloor = 18;
+    lift.numRequests = 4;
+    lift.numMovements = 40;
+
+    // INTEGERS
+    printf("**********************\n");
+    printf("| Rendering Integers |\n");
+    printf("**********************\n");
+
+    // every digit count, both signs and both ends of the range
+    printf("renderInt(): ");
+    int values[] = { 0, 7, 9, 10, 42, 99, 100, 101, 999, 1000, 65536,
+                     1000000, 123456789, INT_MAX, -1, -9, -10, -100,
+                     -123456, INT_MIN };
+    int numValues = sizeof(values) / sizeof(values[0]);
+    int status = 0;
+    for (int ii = 0; ii < numValues; ii++)
+    {
+        int len = renderInt(text, values[ii]);
+        snprintf(expected, sizeof(expected), "%d", values[ii]);
+        if (len != (int)strlen(expected) || strcmp(text, expected) != 0)
+        {
+            status = -1;
+        }
+    }
+    if (status != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // ENTRIES
+    printf("\n*********************\n");
+    printf("| Rendering Entries |\n");
+    printf("*********************\n");
+
+    printf("renderRequestCsv(): ");
+    int len = renderRequestCsv(text, &req);
+    if (len != (int)strlen(text) ||
+        strcmp(text, "request,7,,3,12,,,,\n") != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    printf("renderLiftActivityCsv(): ");
+    len = renderLiftActivityCsv(text, &lift, &req);
+    if (len != (int)strlen(text) ||
+        strcmp(text, "lift,7,2,3,12,18,24,4,64\n") != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // a lift already on the request's floor skips the first move
+    printf("renderLiftActivity() same floor: ");
+    lift.currFloor = 3;
+    len = renderLiftActivity(text, &lift, &req);
+    if (len != (int)strlen(text) ||
+        strstr(text, "Detail operations:\n    Go from Floor 3 to Floor 12\n"
+                     "    #movements for this request: 9\n") == NULL)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // GOLDEN LOGS
+    printf("\n***************\n");
+    printf("| Golden Logs |\n");
+    printf("***************\n");
+
+    for (int ii = 1; ii <= NUM_GOLDEN; ii++)
+    {
+        char path[64];
+        int numEntries = 0;
+        snprintf(path, sizeof(path), GOLDEN_FMT, ii);
+
+        printf("%s: ", path);
+        if (checkGolden(path, &numEntries) != 0 || numEntries == 0)
+        {
+            printf("FAILED\n");
+        }
+        else
+        {
+            printf("PASSED\n");
+        }
+    }
+
+    return 0;
+}
+
+/* ****************************************************************************
+ * NAME:        checkGolden
+ *
+ * PURPOSE:     Read every entry of a prose log back into a request / lift,
+ *              render it again and compare it with the log.
+ *
+ * IMPORT:      path - the log
+ *              numEntries - set to the number of entries that matched
+ * EXPORT:      Error code (-1 = the log can't be read, or an entry differs)
+ * ***************************************************************************/
+static int checkGolden(const char* path, int* numEntries)
+{
+    int status = 0;
+    long size = 0, pos = 0;
+    char text[EVENT_LEN];
+
+    char* log = readFile(path, &size);
+    if (log == NULL)
+    {
+        status = -1;
+    }
+
+    while (status == 0 && pos < size)
+    {
+        Request req = { 0, 0, 0, 1, 0, 0 };
+        Lift lift;
+        int len = -1, total = 0;
+        char* entry = log + pos;
+        memset(&lift, 0, sizeof(Lift));
+
+        char* counts = strstr(entry, "#request:");
+
+        if (sscanf(entry, "%*[-]\nNew Lift Request From Floor %d to Floor "
+                   "%d\nRequest No: %d", &req.start, &req.destination,
+                   &req.num) == 3)
+        {
+            len = renderRequest(text, &req);
+        }
+        else if (sscanf(entry, "Lift-%d Operation\nPrevious position: "
+                        "Floor %d\nRequest: Floor %d to %d", &lift.id,
+                        &lift.currFloor, &req.start, &req.destination) == 4 &&
+                 counts != NULL && sscanf(counts, "#request: %d\n"
+                        "    Total #movement: %d", &lift.numRequests,
+                        &total) == 2)
+        {
+            // The log shows the total after this request
+            lift.numMovements = total - abs(lift.currFloor - req.start) -
+                                abs(req.start - req.destination);
+            len = renderLiftActivity(text, &lift, &req);
+        }
+
+        if (len == -1 || len > size - pos || memcmp(entry, text, len) != 0)
+        {
+            status = -1;
+        }
+        else
+        {
+            pos += len;
+            (*numEntries)++;
+        }
+    }
+
+    free(log);
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        readFile
+ *
+ * PURPOSE:     Read a whole file into memory, '\0' terminated.
+ *
+ * IMPORT:      path - the file
+ *              size - set to its size
+ * EXPORT:      The contents (NULL if it can't be read), to be freed
+ * ***************************************************************************/
+static char* readFile(const char* path, long* size)
+{
+    char* contents = NULL;
+
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror("there was an error opening the file");
+    }
+    else
+    {
+        fseek(file, 0, SEEK_END);
+        *size = ftell(file);
+        rewind(file);
+
+        contents = (char*)malloc(*size + 1);
+        if (fread(contents, 1, *size, file) != (size_t)*size)
+        {
+            free(contents);
+            contents = NULL;
+        }
+        else
+        {
+            contents[*size] = '\0';
+        }
+        fclose(file);
+    }
+
+    return contents;
+}
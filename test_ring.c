@@ -0,0 +1,162 @@
+/* ****************************************************************************
+ * FILE:        test_ring.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Test harness for ring.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "ring.h"
+#include "linked_list.h"
+
+int main(int argc, char const *argv[])
+{
+    const int capacity = 5;
+    Ring* ring = NULL;
+    Request data;
+    Request requests[8];
+    for (int ii = 0; ii < 8; ii++)
+    {
+        requests[ii].num = ii + 1;
+        requests[ii].start = ii + 1;
+        requests[ii].destination = ii + ii + 2;
+        requests[ii].building = 1;
+    }
+
+    // CREATING
+    printf("*****************\n");
+    printf("| Creating Ring |\n");
+    printf("*****************\n");
+
+    printf("initRing(5): ");
+    ring = (Ring*)malloc(ringBytes(capacity));
+    initRing(ring, capacity);
+
+    if (ring->size == 8 && ring->mask == 7 && 
+        ring->head == 0 && ring->tail == 0 && popRing(ring, &data) == -1)
+    {
+        printf("PASSED\n");
+    }
+    else
+    {
+        printf("FAILED\n");
+    }
+
+    // PUSHING
+    printf("\n***********\n");
+    printf("| Pushing |\n");
+    printf("***********\n");
+
+    // push into empty ring
+    printf("pushRing() 1: ");
+    if (pushRing(ring, &requests[0]) == 0 && ring->head == 1)
+    {
+        printf("PASSED\n");
+    }
+    else
+    {
+        printf("FAILED\n");
+    }
+
+    // fill the ring (rounded up to 8)
+    printf("pushRing() 2: ");
+    int status = 0;
+    for (int ii = 1; ii < 8; ii++)
+    {
+        status |= pushRing(ring, &requests[ii]);
+    }
+
+    if (status != 0 || pushRing(ring, &requests[0]) != -1)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // POPPING
+    printf("\n***********\n");
+    printf("| Popping |\n");
+    printf("***********\n");
+
+    // pop full ring
+    printf("popRing() 1: ");
+    if (popRing(ring, &data) != 0 || data.num != requests[0].num ||
+        data.start != requests[0].start || 
+        data.destination != requests[0].destination)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // wrap around: push into the freed slot, then empty the ring in order
+    printf("popRing() 2: ");
+    status = pushRing(ring, &requests[0]);
+    for (int ii = 1; ii < 8; ii++)
+    {
+        status |= popRing(ring, &data);
+        if (data.num != requests[ii].num)
+        {
+            status = -1;
+        }
+    }
+    status |= popRing(ring, &data);
+
+    if (status != 0 || data.num != requests[0].num || 
+        popRing(ring, &data) != -1)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // PEEKING
+    printf("\n***********\n");
+    printf("| Peeking |\n");
+    printf("***********\n");
+
+    printf("peekRing(): ");
+    pushRing(ring, &requests[2]);
+    if (peekRing(ring, &data) != 0 || data.num != requests[2].num ||
+        ringCount(ring) != 1)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // a pop abandoned half way leaves its cell unusable until repaired
+    printf("repairRing(): ");
+    ring->tail++;
+    repairRing(ring);
+    status = 0;
+    for (int ii = 0; ii < 8; ii++)
+    {
+        status |= pushRing(ring, &requests[ii]);
+    }
+
+    if (status != 0 || ringCount(ring) != 8 || 
+        popRing(ring, &data) != 0 || data.num != requests[0].num)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    free(ring);
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+/* ****************************************************************************
+ * FILE:        test_solve.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ *
+ * PURPOSE:     Test harness for solve.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "solve.h"
+#include "replay.h"
+
+int main(int argc, char *argv[])
+{
+    Trips trips;
+    Options opts;
+    Solution sol;
+    long long restarts = 0;
+    int threads = 0;
+
+    // BOUND
+    printf("***************\n");
+    printf("| Lower Bound |\n");
+    printf("***************\n");
+
+    // there and back again, nothing is moved empty
+    printf("emptyBound() 1: ");
+    memset(trips, 0, sizeof(Trips));
+    trips[1][5] = 1;
+    trips[5][1] = 1;
+    if (carryingMovement(trips) != 8 || emptyBound(trips, 1) != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // a second lift only helps if it saves coming back down
+    printf("emptyBound() 2: ");
+    memset(trips, 0, sizeof(Trips));
+    trips[1][20] = 2;
+    if (emptyBound(trips, 1) != 19 || emptyBound(trips, 2) != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    printf("emptyBound() 3: ");
+    memset(trips, 0, sizeof(Trips));
+    trips[10][12] = 2;
+    if (emptyBound(trips, 2) != 11 || emptyBound(trips, 1) != 11)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // SEARCH
+    printf("\n**********\n");
+    printf("| Search |\n");
+    printf("**********\n");
+
+    printf("bestSchedule() 1: ");
+    if (bestSchedule(trips, 1, 11, &restarts, &threads) != 11 ||
+        restarts < 1 || threads < 1)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // a random building: no schedule beats the bound
+    printf("bestSchedule() 2: ");
+    LinkedList* requests = createLinkedList();
+    srand(1);
+    for (int ii = 0; ii < 100; ii++)
+    {
+        Request* req = (Request*)malloc(sizeof(Request));
+        req->num = ii + 1;
+        req->start = rand() % NUM_FLOORS + 1;
+        req->destination = rand() % NUM_FLOORS + 1;
+        req->building = 1;
+        insertLast(requests, req);
+    }
+
+    opts.numLifts = 3;
+    opts.liftDelay = 0;
+    memset(&opts.travel, 0, sizeof(TravelModel));
+    solveBuilding(requests, 1, &opts, &sol);
+    if (sol.requests != 100 || sol.bound < sol.carrying ||
+        sol.best < sol.bound || sol.fifo < sol.best)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // REPLAY
+    printf("\n**********\n");
+    printf("| Replay |\n");
+    printf("**********\n");
+
+    // 1 -> 3 -> 5, then 5 -> 2 -> 1, in order on one lift
+    printf("fifoMovement(): ");
+    freeLinkedList(requests);
+    requests = createLinkedList();
+    for (int ii = 0; ii < 2; ii++)
+    {
+        Request* req = (Request*)malloc(sizeof(Request));
+        req->num = ii + 1;
+        req->start = (ii == 0) ? 3 : 2;
+        req->destination = (ii == 0) ? 5 : 1;
+        req->building = 1;
+        insertLast(requests, req);
+    }
+
+    opts.numLifts = 1;
+    if (fifoMovement(requests, 1, &opts) != 8 ||
+        fifoMovement(requests, 2, &opts) != 0)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    // every specialised kernel agrees with the generic one
+    printf("replayKernel(): ");
+    for (int ii = 0; ii < 1000; ii++)
+    {
+        Request* req = (Request*)malloc(sizeof(Request));
+        req->num = ii + 3;
+        req->start = rand() % NUM_FLOORS + 1;
+        req->destination = rand() % NUM_FLOORS + 1;
+        req->building = 1;
+        insertLast(requests, req);
+    }
+
+    TravelModel travel = { 3, 5, 2, 1 };
+    Replay* replay = createReplay(requests, 1, 7, &travel);
+    int status = 0;
+    for (int ii = 1; ii <= MAX_SPECIALISED_LIFTS + 1; ii++)
+    {
+        if (replayKernel(ii)(replay, ii) != replayGeneric(replay, ii))
+        {
+            status = -1;
+        }
+    }
+
+    if (status != 0 || replay->numRequests != 1002 ||
+        replayKernel(3) == replayGeneric || 
+        replayKernel(MAX_SPECIALISED_LIFTS + 1) != replayGeneric)
+    {
+        printf("FAILED\n");
+    }
+    else
+    {
+        printf("PASSED\n");
+    }
+
+    freeReplay(replay);
+    freeLinkedList(requests);
+
+    return 0;
+}
@@ -0,0 +1,302 @@
+/* ****************************************************************************
+ * FILE:        topology.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     CPU and NUMA placement of the producer and lifts (--pin and
+ *              --cpus). The CPUs come from the process's affinity mask (or
+ *              a list like "0,2,4-7"), and the NUMA node of each CPU from
+ *              sysfs, so there is nothing to link against. Memory follows
+ *              the kernel's first-touch policy: whatever a building's
+ *              producer CPU allocates and initialises lands on its node.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "topology.h"
+
+#define NODE_CPULIST "/sys/devices/system/node/node%d/cpulist"
+
+static void readNodes(Topology* topo);
+
+/* ****************************************************************************
+ * NAME:        parseCpuList
+ * 
+ * PURPOSE:     Read a list of CPUs of the form "0,2,4-7" (the format of
+ *              --cpus and of sysfs).
+ * 
+ * IMPORT:      str - the list
+ *              cpus - filled in, in the order given
+ *              max - room in cpus
+ * EXPORT:      Number of CPUs read (-1 = invalid list)
+ * ***************************************************************************/
+int parseCpuList(const char* str, int* cpus, int max)
+{
+    int count = 0;
+    const char* pos = str;
+
+    while (count != -1 && *pos != '\0' && *pos != '\n')
+    {
+        char* end;
+        long first = strtol(pos, &end, 10);
+        long last = first;
+
+        if (end == pos || first < 0 || first >= MAX_CPUS)
+        {
+            count = -1;
+        }
+        else
+        {
+            pos = end;
+            if (*pos == '-')
+            {
+                last = strtol(pos + 1, &end, 10);
+                if (end == pos + 1 || last < first || last >= MAX_CPUS)
+                {
+                    count = -1;
+                }
+                pos = end;
+            }
+            if (*pos == ',')
+            {
+                pos++;
+            }
+            else if (*pos != '\0' && *pos != '\n')
+            {
+                count = -1;
+            }
+
+            for (long cc = first; cc <= last && count != -1; cc++)
+            {
+                if (count == max)
+                {
+                    count = -1;
+                }
+                else
+                {
+                    cpus[count++] = (int)cc;
+                }
+            }
+        }
+    }
+
+    if (count == 0)
+    {
+        count = -1;
+    }
+
+    return count;
+}
+
+/* ****************************************************************************
+ * NAME:        readTopology
+ * 
+ * PURPOSE:     Find the CPUs the process may run on and their NUMA nodes,
+ *              and the CPUs to place threads on.
+ * 
+ * IMPORT:      cpuList - CPUs to place threads on (NULL = every allowed CPU)
+ *              topo - filled in
+ * EXPORT:      Error code (-1 = the list is invalid or has a CPU the process
+ *              can't run on)
+ * ***************************************************************************/
+int readTopology(const char* cpuList, Topology* topo)
+{
+    int status = 0;
+    cpu_set_t mask;
+
+    topo->numAllowed = 0;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &mask) == -1)
+    {
+        perror("failed to read the CPU affinity");
+        status = -1;
+    }
+    else
+    {
+        for (int ii = 0; ii < MAX_CPUS; ii++)
+        {
+            if (CPU_ISSET(ii, &mask))
+            {
+                topo->allowed[topo->numAllowed++] = ii;
+            }
+        }
+    }
+
+    if (status == 0 && cpuList == NULL)
+    {
+        topo->numCpus = topo->numAllowed;
+        memcpy(topo->cpus, topo->allowed, sizeof(int) * topo->numAllowed);
+    }
+    else if (status == 0)
+    {
+        topo->numCpus = parseCpuList(cpuList, topo->cpus, MAX_CPUS);
+        if (topo->numCpus == -1)
+        {
+            printf("wrong args: --cpus expects a list like 0,2,4-7\n");
+            status = -1;
+        }
+        for (int ii = 0; ii < topo->numCpus && status == 0; ii++)
+        {
+            if (!CPU_ISSET(topo->cpus[ii], &mask))
+            {
+                printf("wrong args: cpu %d is not available\n", 
+                       topo->cpus[ii]);
+                status = -1;
+            }
+        }
+    }
+
+    if (status == 0)
+    {
+        readNodes(topo);
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        readNodes
+ * 
+ * PURPOSE:     Fill in the NUMA node of every CPU from sysfs. Without NUMA
+ *              (or sysfs) every CPU is on node 0.
+ * 
+ * IMPORT:      topo - nodeOf and numNodes filled in
+ * ***************************************************************************/
+static void readNodes(Topology* topo)
+{
+    char path[64], line[4096];
+    int* cpus = (int*)malloc(sizeof(int) * MAX_CPUS);
+
+    memset(topo->nodeOf, 0, sizeof(topo->nodeOf));
+    topo->numNodes = 0;
+
+    for (int node = 0; node < MAX_NODES; node++)
+    {
+        snprintf(path, sizeof(path), NODE_CPULIST, node);
+        FILE* file = fopen(path, "r");
+        if (file != NULL)
+        {
+            topo->numNodes++;
+            if (fgets(line, sizeof(line), file) != NULL)
+            {
+                int count = parseCpuList(line, cpus, MAX_CPUS);
+                for (int ii = 0; ii < count; ii++)
+                {
+                    topo->nodeOf[cpus[ii]] = node;
+                }
+            }
+            fclose(file);
+        }
+    }
+
+    if (topo->numNodes == 0)
+    {
+        topo->numNodes = 1;
+    }
+
+    free(cpus);
+}
+
+/* ****************************************************************************
+ * NAME:        placeCpu
+ * 
+ * PURPOSE:     Returns the CPU for a thread: slot n takes the n-th CPU of
+ *              the placement list, wrapping around.
+ * 
+ * IMPORT:      topo - the topology
+ *              slot - producer or lift, counted from 0 across buildings
+ * EXPORT:      CPU number
+ * ***************************************************************************/
+int placeCpu(const Topology* topo, int slot)
+{
+    return topo->cpus[slot % topo->numCpus];
+}
+
+/* ****************************************************************************
+ * NAME:        pinSelf
+ * 
+ * PURPOSE:     Restrict the calling thread (or process) to one CPU.
+ * 
+ * IMPORT:      cpu - the CPU
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int pinSelf(int cpu)
+{
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+
+    int status = sched_setaffinity(0, sizeof(cpu_set_t), &mask);
+    if (status == -1)
+    {
+        perror("failed to pin to a cpu");
+    }
+
+    return status;
+}
+
+/* ****************************************************************************
+ * NAME:        unpinSelf
+ * 
+ * PURPOSE:     Let the calling thread run on every CPU it was allowed to
+ *              when the topology was read.
+ * 
+ * IMPORT:      topo - the topology
+ * EXPORT:      Error code (-1 = problem occured)
+ * ***************************************************************************/
+int unpinSelf(const Topology* topo)
+{
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int ii = 0; ii < topo->numAllowed; ii++)
+    {
+        CPU_SET(topo->allowed[ii], &mask);
+    }
+
+    return sched_setaffinity(0, sizeof(cpu_set_t), &mask);
+}
+
+/* ****************************************************************************
+ * NAME:        printTopology
+ * 
+ * PURPOSE:     Print the CPUs and nodes available and used for placement.
+ * 
+ * IMPORT:      topo - the topology
+ * ***************************************************************************/
+void printTopology(const Topology* topo)
+{
+    printf("Topology: %d CPUs available on %d NUMA node%s, placing on", 
+           topo->numAllowed, topo->numNodes, topo->numNodes == 1 ? "" : "s");
+    for (int ii = 0; ii < topo->numCpus; ii++)
+    {
+        printf("%s%d", ii == 0 ? " cpu " : ",", topo->cpus[ii]);
+    }
+    printf("\n");
+}
+
+/* ****************************************************************************
+ * NAME:        printPlacement
+ * 
+ * PURPOSE:     Print where a building's producer and lifts were placed.
+ * 
+ * IMPORT:      topo - the topology
+ *              title - e.g. "Building 1"
+ *              producerCpu - CPU of Lift-R
+ *              lifts - the lifts (cpu filled in)
+ *              numLifts - length of the array
+ * ***************************************************************************/
+void printPlacement(const Topology* topo, const char* title, int producerCpu,
+                    const Lift* lifts, int numLifts)
+{
+    printf("%s: Lift-R on cpu %d (node %d)", title, producerCpu, 
+           topo->nodeOf[producerCpu]);
+    for (int ii = 0; ii < numLifts; ii++)
+    {
+        printf(", Lift-%d on cpu %d (node %d)", lifts[ii].id, lifts[ii].cpu,
+               topo->nodeOf[lifts[ii].cpu]);
+    }
+    printf("\n");
+}
@@ -0,0 +1,43 @@
+/* ****************************************************************************
+ * FILE:        topology.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for topology.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#include "lift_sim.h"
+
+#ifndef TOPOLOGY
+#define TOPOLOGY
+
+#define MAX_CPUS 1024 // CPU_SETSIZE
+#define MAX_NODES 64
+
+// Where the sim's threads (or processes) may run, and where to put them.
+// allowed = CPUs the process may run on when it starts (taskset, cgroups)
+// cpus = CPUs to place threads on, in order: a building's producer takes
+// the next one, then each of its lifts (wrapping around)
+// nodeOf = NUMA node of every CPU, by CPU number (0 if the kernel can't say)
+typedef struct Topology
+{
+    int numAllowed;
+    int allowed[MAX_CPUS];
+    int numCpus;
+    int cpus[MAX_CPUS];
+    int numNodes;
+    int nodeOf[MAX_CPUS];
+} Topology;
+
+#endif
+
+// Prototype Declarations
+int parseCpuList(const char* str, int* cpus, int max);
+int readTopology(const char* cpuList, Topology* topo);
+int placeCpu(const Topology* topo, int slot);
+int pinSelf(int cpu);
+int unpinSelf(const Topology* topo);
+void printTopology(const Topology* topo);
+void printPlacement(const Topology* topo, const char* title, int producerCpu,
+                    const Lift* lifts, int numLifts);
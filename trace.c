@@ -0,0 +1,243 @@
+/* ****************************************************************************
+ * FILE:        trace.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Timeline export of lift and thread activity in the Chrome 
+ *              trace-event JSON format, for chrome://tracing or Perfetto.
+ *
+ *              Every thread formats events into its own buffer and writes 
+ *              the whole buffer with a single write() once it fills up.
+ *              The file is opened with O_APPEND, so those writes never 
+ *              interleave, even between the processes of implementation B, 
+ *              and no lock is needed.
+ *
+ *              Events are "B"/"E" (begin/end) pairs, "i" (instant) and "M"
+ *              (thread name) events with timestamps in microseconds.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "trace.h"
+#include "profile.h"
+
+static void traceEvent(TraceThread* tt, const char* name, char phase, 
+                       const char* args);
+static int writeAll(int fd, const char* buf, int len);
+
+/* ****************************************************************************
+ * NAME:        openTrace
+ * 
+ * PURPOSE:     Create (or truncate) the trace file and start the clock.
+ * 
+ * IMPORT:      path - name of the trace file
+ * EXPORT:      pointer to the trace (NULL = problem occured)
+ * ***************************************************************************/
+Trace* openTrace(const char* path)
+{
+    Trace* trace = NULL;
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0666);
+    if (fd == -1)
+    {
+        perror("there was an error opening the trace file");
+    }
+    else
+    {
+        trace = (Trace*)malloc(sizeof(Trace));
+        trace->fd = fd;
+        trace->startNs = profileNow();
+        writeAll(fd, "[\n", 2);
+    }
+
+    return trace;
+}
+
+/* ****************************************************************************
+ * NAME:        closeTrace
+ * 
+ * PURPOSE:     Terminate the JSON array and close the trace file. Every 
+ *              thread must have flushed before this is called.
+ * 
+ * IMPORT:      Pointer to the trace (may be NULL)
+ * ***************************************************************************/
+void closeTrace(Trace* trace)
+{
+    if (trace != NULL)
+    {
+        // Every event ends in a comma, so finish with one that doesn't
+        const char* last = "{\"name\":\"end\",\"ph\":\"M\",\"pid\":0,\"tid\":0}\n]\n";
+        writeAll(trace->fd, last, strlen(last));
+        close(trace->fd);
+        free(trace);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        detachTrace
+ * 
+ * PURPOSE:     Release a forked child's copy of the trace without ending the
+ *              JSON array (the parent closes the trace once every child has
+ *              exited).
+ * 
+ * IMPORT:      Pointer to the trace (may be NULL)
+ * ***************************************************************************/
+void detachTrace(Trace* trace)
+{
+    if (trace != NULL)
+    {
+        close(trace->fd);
+        free(trace);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        traceThreadInit
+ * 
+ * PURPOSE:     Prepare a thread's trace buffer and name the thread.
+ * 
+ * IMPORT:      tt - the thread's trace buffer
+ *              trace - the trace (NULL = tracing off)
+ *              pid - process id to show events under (e.g. building)
+ *              tid - thread id to show events under (e.g. lift)
+ *              name - thread name shown in the viewer
+ * ***************************************************************************/
+void traceThreadInit(TraceThread* tt, Trace* trace, int pid, int tid, 
+                     const char* name)
+{
+    tt->trace = trace;
+    tt->pid = pid;
+    tt->tid = tid;
+    tt->len = 0;
+
+    if (trace != NULL)
+    {
+        tt->len += snprintf(tt->buf, TRACE_BUF,
+                            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                            "\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n",
+                            pid, tid, name);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        traceBegin, traceEnd
+ * 
+ * PURPOSE:     Record the start or end of a span (e.g. a lock wait).
+ * 
+ * IMPORT:      tt - the thread's trace buffer
+ *              name - name of the span
+ * ***************************************************************************/
+void traceBegin(TraceThread* tt, const char* name)
+{
+    if (tt != NULL && tt->trace != NULL)
+    {
+        traceEvent(tt, name, 'B', "");
+    }
+}
+
+void traceEnd(TraceThread* tt, const char* name)
+{
+    if (tt != NULL && tt->trace != NULL)
+    {
+        traceEvent(tt, name, 'E', "");
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        traceMoveBegin
+ * 
+ * PURPOSE:     Record the start of a lift moving between two floors. End it
+ *              with traceEnd(tt, "move").
+ * 
+ * IMPORT:      tt - the thread's trace buffer
+ *              from, to - the floors
+ * ***************************************************************************/
+void traceMoveBegin(TraceThread* tt, int from, int to)
+{
+    if (tt != NULL && tt->trace != NULL)
+    {
+        char args[TRACE_ARGS];
+        snprintf(args, TRACE_ARGS, ",\"args\":{\"from\":%d,\"to\":%d}", 
+                 from, to);
+        traceEvent(tt, "move", 'B', args);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        traceInstant
+ * 
+ * PURPOSE:     Record something happening to a request at a point in time
+ *              (e.g. being added to or taken from the buffer).
+ * 
+ * IMPORT:      tt - the thread's trace buffer
+ *              name - name of the event
+ *              reqNum - request number
+ * ***************************************************************************/
+void traceInstant(TraceThread* tt, const char* name, int reqNum)
+{
+    if (tt != NULL && tt->trace != NULL)
+    {
+        char args[TRACE_ARGS];
+        snprintf(args, TRACE_ARGS, ",\"s\":\"t\",\"args\":{\"request\":%d}", 
+                 reqNum);
+        traceEvent(tt, name, 'i', args);
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        traceFlush
+ * 
+ * PURPOSE:     Write out everything in a thread's trace buffer.
+ * 
+ * IMPORT:      tt - the thread's trace buffer
+ * ***************************************************************************/
+void traceFlush(TraceThread* tt)
+{
+    if (tt != NULL && tt->trace != NULL && tt->len > 0)
+    {
+        writeAll(tt->trace->fd, tt->buf, tt->len);
+        tt->len = 0;
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        traceEvent
+ * 
+ * PURPOSE:     Format one event into the thread's buffer, flushing first if
+ *              it might not fit. args = extra JSON fields, starting with ','
+ * ***************************************************************************/
+static void traceEvent(TraceThread* tt, const char* name, char phase, 
+                       const char* args)
+{
+    if (tt->len > TRACE_BUF - TRACE_EVENT_MAX)
+    {
+        traceFlush(tt);
+    }
+
+    double ts = (profileNow() - tt->trace->startNs) / 1000.0;
+    tt->len += snprintf(tt->buf + tt->len, TRACE_BUF - tt->len,
+                        "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,"
+                        "\"pid\":%d,\"tid\":%d%s},\n", 
+                        name, phase, ts, tt->pid, tt->tid, args);
+}
+
+/* ****************************************************************************
+ * NAME:        writeAll
+ * 
+ * PURPOSE:     write() a whole string, reporting any failure.
+ * ***************************************************************************/
+static int writeAll(int fd, const char* buf, int len)
+{
+    int status = 0;
+    if (write(fd, buf, len) != len)
+    {
+        perror("there was an error writing the trace file");
+        status = -1;
+    }
+
+    return status;
+}
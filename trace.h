@@ -0,0 +1,50 @@
+/* ****************************************************************************
+ * FILE:        trace.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for trace.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+
+#ifndef TRACE
+#define TRACE
+
+// Bytes of events each thread buffers before writing them out
+#define TRACE_BUF 65536
+#define TRACE_EVENT_MAX 256
+#define TRACE_ARGS 96
+
+// An open trace file, shared by every thread (and process)
+typedef struct Trace
+{
+    int fd;
+    long long startNs;
+} Trace;
+
+// One thread's view of the trace: its ids and its private write buffer.
+// trace = NULL (or a NULL TraceThread) means tracing is off and every call
+// does nothing.
+typedef struct TraceThread
+{
+    Trace* trace;
+    int pid;
+    int tid;
+    int len;
+    char buf[TRACE_BUF];
+} TraceThread;
+
+#endif
+
+// Prototype Declarations
+Trace* openTrace(const char* path);
+void closeTrace(Trace* trace);
+void detachTrace(Trace* trace);
+void traceThreadInit(TraceThread* tt, Trace* trace, int pid, int tid, 
+                     const char* name);
+void traceBegin(TraceThread* tt, const char* name);
+void traceEnd(TraceThread* tt, const char* name);
+void traceMoveBegin(TraceThread* tt, int from, int to);
+void traceInstant(TraceThread* tt, const char* name, int reqNum);
+void traceFlush(TraceThread* tt);
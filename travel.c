@@ -0,0 +1,86 @@
+/* ****************************************************************************
+ * FILE:        travel.c
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     The travel model: how long a lift takes to move between two
+ *              floors, with millisecond resolution.
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "travel.h"
+
+/* ****************************************************************************
+ * NAME:        legTimeMs
+ * 
+ * PURPOSE:     Returns how long one leg of a lift's journey takes.
+ * 
+ * IMPORT:      travel - the travel model (NULL = flat delay only)
+ *              stopMs - fixed overhead of every leg (the lift delay)
+ *              distance - number of floors travelled
+ * EXPORT:      Milliseconds
+ * ***************************************************************************/
+int legTimeMs(const TravelModel* travel, int stopMs, int distance)
+{
+    int ms = stopMs;
+    if (travel != NULL)
+    {
+        ms += travel->doorMs;
+        if (distance > 0)
+        {
+            ms += travel->accelMs + distance * travel->floorMs;
+        }
+    }
+
+    return ms;
+}
+
+/* ****************************************************************************
+ * NAME:        sleepMs
+ * 
+ * PURPOSE:     Sleep for a number of milliseconds (does nothing for 0).
+ * 
+ * IMPORT:      ms - milliseconds
+ * ***************************************************************************/
+void sleepMs(int ms)
+{
+    if (ms > 0)
+    {
+        struct timespec req = { ms / 1000, (ms % 1000) * 1000000L };
+        while (nanosleep(&req, &req) == -1); // resume if interrupted
+    }
+}
+
+/* ****************************************************************************
+ * NAME:        parseTravelModel
+ * 
+ * PURPOSE:     Read a travel model from a string of the form 
+ *              "<floor_ms>,<accel_ms>,<door_ms>".
+ * 
+ * IMPORT:      str - the string
+ *              travel - model to fill in (virtualTime is left alone)
+ * EXPORT:      Error code (-1 = invalid string)
+ * ***************************************************************************/
+int parseTravelModel(const char* str, TravelModel* travel)
+{
+    int floorMs, accelMs, doorMs, status = 0;
+    char extra;
+
+    if (sscanf(str, "%d,%d,%d%c", &floorMs, &accelMs, &doorMs, &extra) != 3 ||
+        floorMs < 0 || accelMs < 0 || doorMs < 0)
+    {
+        status = -1;
+    }
+    else
+    {
+        travel->floorMs = floorMs;
+        travel->accelMs = accelMs;
+        travel->doorMs = doorMs;
+    }
+
+    return status;
+}
@@ -0,0 +1,34 @@
+/* ****************************************************************************
+ * FILE:        travel.h
+ * AUTHOR:      Matthew Di Marco
+ * UNIT:        Operating Systems
+ * 
+ * PURPOSE:     Header file for travel.c
+ *
+ * LAST MOD:    19/10/26
+ * ***************************************************************************/
+
+#ifndef TRAVEL
+#define TRAVEL
+
+// How long a lift takes to travel, in milliseconds.
+// floorMs = cruising time per floor travelled
+// accelMs = speeding up plus slowing down, once per leg that moves at all
+// doorMs = doors opening, dwelling and closing at the end of every leg
+// virtualTime = don't sleep, only add the time up (for benchmarking)
+// The lift delay from the command line is added to every leg as a fixed
+// stop overhead, so the all-zero model behaves like the original flat delay.
+typedef struct TravelModel
+{
+    int floorMs;
+    int accelMs;
+    int doorMs;
+    int virtualTime;
+} TravelModel;
+
+#endif
+
+// Prototype Declarations
+int legTimeMs(const TravelModel* travel, int stopMs, int distance);
+void sleepMs(int ms);
+int parseTravelModel(const char* str, TravelModel* travel);